@@ -2,6 +2,8 @@ import argparse
 import yaml
 
 import src.stuff_sack as ss
+from src import descriptor_blob
+from src import perfect_hash
 from src import utils
 
 
@@ -384,17 +386,78 @@ def yaml_log_header(spec, messages):
   return f'static const char kYamlHeader[] = "{yaml.dump(spec).encode("unicode_escape").decode()}";'
 
 
-def write_log_header():
-  return '''\
-int SsWriteLogHeader(void *fd) {
-  int yaml_ret = SsWriteFile(fd, kYamlHeader, sizeof(kYamlHeader) - 1);
-  if (yaml_ret < 0) return yaml_ret;
+def blob_log_header(all_types):
+  blob = descriptor_blob.to_blob(all_types)
+
+  s = 'static const uint8_t kSsDescriptorBlob[] = {\n'
+  for i in range(0, len(blob), 12):
+    s += '    ' + ' '.join(f'0x{x:02X},' for x in blob[i:i + 12]) + '\n'
+  s += '};'
+
+  return s
+
+
+def uid_lookup(messages):
+  table = perfect_hash.find([msg.uid for msg in messages])
+  index_type = 'uint16_t' if len(messages) < 0xFFFF else 'uint32_t'
+
+  # Trailing entry is the target of empty slots.
+  s = f'static const uint32_t kMessageUids[{len(messages) + 1}] = {{\n'
+  for msg in messages:
+    s += f'  {msg.uid:#010x},\n'
+  s += '  0x00000000,\n'
+  s += '};\n\n'
+
+  s += f'static const SsMsgType kSsMsgTypes[{len(messages) + 1}] = {{\n'
+  for msg in messages:
+    s += f'  kSsMsgType{msg.name},\n'
+  s += '  kSsMsgTypeUnknown,\n'
+  s += '};\n\n'
+
+  s += '// Collision free hash of UID to index in kMessageUids.  See src/perfect_hash.py.\n'
+  s += f'static const {index_type} kSsMsgUidDisplacements[{len(table.displacements)}] = {{\n'
+  for i in range(0, len(table.displacements), 12):
+    s += '  ' + ' '.join(f'{x},' for x in table.displacements[i:i + 12]) + '\n'
+  s += '};\n\n'
+
+  s += f'static const {index_type} kSsMsgUidSlots[{len(table.slots)}] = {{\n'
+  for i in range(0, len(table.slots), 12):
+    s += '  ' + ' '.join(f'{x},' for x in table.slots[i:i + 12]) + '\n'
+  s += '};\n\n'
+
+  s += f'''\
+static inline SsMsgType GetSsMsgTypeFromUid(uint32_t uid) {{
+  const uint32_t d = kSsMsgUidDisplacements[(uint32_t)(uid * {table.bucket_mult:#010x}u) >> {table.bucket_shift}];
+  const {index_type} i = kSsMsgUidSlots[(((uint32_t)(uid * {table.mult:#010x}u) >> {table.shift}) + d) & {table.mask:#x}u];
+  return uid == kMessageUids[i] ? kSsMsgTypes[i] : kSsMsgTypeUnknown;
+}}'''
+
+  return s
 
+
+def write_log_header(log_header):
+  headers = []
+  if log_header in ('blob', 'both'):
+    headers.append(('blob', 'kSsDescriptorBlob, sizeof(kSsDescriptorBlob)'))
+  if log_header in ('yaml', 'both'):
+    headers.append(('yaml', 'kYamlHeader, sizeof(kYamlHeader) - 1'))
+
+  s = 'int SsWriteLogHeader(void *fd) {\n'
+  for name, args in headers:
+    s += f'''\
+  int {name}_ret = SsWriteFile(fd, {args});
+  if ({name}_ret < 0) return {name}_ret;
+
+'''
+
+  s += f'''\
   int delim_ret = SsWriteFile(fd, kSsLogDelimiter, sizeof(kSsLogDelimiter) - 1);
   if (delim_ret < 0) return delim_ret;
 
-  return yaml_ret + delim_ret;
-}'''
+  return {" + ".join(f"{name}_ret" for name, _ in headers)} + delim_ret;
+}}'''
+
+  return s
 
 
 def find_log_delimiter():
@@ -510,7 +573,7 @@ def c_header(all_types, includes):
   return s[:-1]
 
 
-def c_file(spec, all_types, headers):
+def c_file(spec, all_types, headers, log_header='yaml'):
   messages = [x for x in all_types if isinstance(x, ss.Message)]
 
   s = ''
@@ -532,38 +595,20 @@ def c_file(spec, all_types, headers):
     s += '{}\n\n'.format(pack(t))
     s += '{}\n\n'.format(unpack(t))
 
-  s += 'static const uint32_t kMessageUids[{}] = {{\n'.format(len(messages))
-
-  for msg in messages:
-    s += f'  {msg.uid:#010x},\n'
-
-  s += '};\n\n'
-
-  s += f'static const SsMsgType kSsMsgTypes[{len(messages)}] = {{\n'
-
-  for msg in messages:
-    s += f'  kSsMsgType{msg.name},\n'
-
-  s += '};\n\n'
+  s += uid_lookup(messages) + '\n\n'
 
   s += '''\
-static inline SsMsgType GetSsMsgTypeFromUid(uint32_t uid) {
-  for (int32_t i = 0; i < sizeof(kMessageUids) / sizeof(kMessageUids[0]); ++i) {
-    if (uid == kMessageUids[i]) {
-      return kSsMsgTypes[i];
-    }
-  }
-  return kSsMsgTypeUnknown;
-}
-
 SsMsgType SsInspectHeader(const uint8_t *buffer) {
   SsHeader header;
   SsUnpackSsHeader(buffer, &header);
   return GetSsMsgTypeFromUid(header.uid);
 }\n\n'''
 
-  s += yaml_log_header(spec, messages) + '\n\n'
-  s += write_log_header() + '\n\n'
+  if log_header in ('blob', 'both'):
+    s += blob_log_header(all_types) + '\n\n'
+  if log_header in ('yaml', 'both'):
+    s += yaml_log_header(spec, messages) + '\n\n'
+  s += write_log_header(log_header) + '\n\n'
   s += find_log_delimiter() + '\n\n'
 
   for msg in messages:
@@ -593,6 +638,10 @@ def main():
   parser.add_argument('--header', required=True, help='Library header file name.')
   parser.add_argument('--includes', nargs='+', default=[], help='Additional includes.')
   parser.add_argument('--alias_tag', help='Alias tag to be used for generation.')
+  parser.add_argument('--log_header',
+                      choices=['yaml', 'blob', 'both'],
+                      default='yaml',
+                      help='Log header format.  "both" writes the blob followed by the YAML.')
   args = parser.parse_args()
 
   with open(args.spec, 'r') as f:
@@ -606,7 +655,7 @@ def main():
   with open(args.source, 'w') as f:
     includes = [args.header] + args.includes
 
-    f.write(c_file(spec, all_types, includes))
+    f.write(c_file(spec, all_types, includes, args.log_header))
 
 
 if __name__ == '__main__':
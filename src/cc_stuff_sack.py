@@ -2,6 +2,7 @@ import argparse
 
 import src.stuff_sack as ss
 import src.c_stuff_sack as c_ss
+from src import perfect_hash
 from src import utils
 
 
@@ -34,20 +35,40 @@ using AnyMessage = std::variant<
 
 def inspect_header_definition(messages):
   n = '\n'
+  table = perfect_hash.find([m.uid for m in messages])
+  index_type = 'uint16_t' if len(messages) < 0xFFFF else 'uint32_t'
+  displacement_lines = [
+      '  ' + ' '.join(f'{x},' for x in table.displacements[i:i + 12])
+      for i in range(0, len(table.displacements), 12)
+  ]
+  slot_lines = [
+      '  ' + ' '.join(f'{x},' for x in table.slots[i:i + 12])
+      for i in range(0, len(table.slots), 12)
+  ]
+
   return f'''\
-static constexpr uint32_t kMessageUids[{len(messages)}] = {{
-{n.join([f'  {m.uid:#010x},' for m in messages])}
+// Trailing entry is the target of empty slots.
+static constexpr uint32_t kMessageUids[{len(messages) + 1}] = {{
+{n.join([f'  {m.uid:#010x},' for m in messages] + ['  0x00000000,'])}
+}};
+
+static constexpr MsgType kMessageTypes[{len(messages) + 1}] = {{
+{n.join([f'  MsgType::k{m.name},' for m in messages] + ['  MsgType::kUnknown,'])}
 }};
 
-static constexpr MsgType kMessageTypes[{len(messages)}] = {{
-{n.join([f'  MsgType::k{m.name},' for m in messages])}
+// Collision free hash of UID to index in kMessageUids.  See src/perfect_hash.py.
+static constexpr {index_type} kMessageUidDisplacements[{len(table.displacements)}] = {{
+{n.join(displacement_lines)}
+}};
+
+static constexpr {index_type} kMessageUidSlots[{len(table.slots)}] = {{
+{n.join(slot_lines)}
 }};
 
 static inline constexpr MsgType GetMsgTypeFromUid(uint32_t uid) {{
-  for (size_t i = 0; i < {len(messages)}; ++i) {{
-    if (uid == kMessageUids[i]) return kMessageTypes[i];
-  }}
-  return MsgType::kUnknown;
+  const uint32_t d = kMessageUidDisplacements[static_cast<uint32_t>(uid * {table.bucket_mult:#010x}u) >> {table.bucket_shift}];
+  const {index_type} i = kMessageUidSlots[((static_cast<uint32_t>(uid * {table.mult:#010x}u) >> {table.shift}) + d) & {table.mask:#x}u];
+  return uid == kMessageUids[i] ? kMessageTypes[i] : MsgType::kUnknown;
 }}
 
 MsgType InspectHeader(const uint8_t *buffer) {{
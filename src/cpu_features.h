@@ -0,0 +1,45 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define SS_X86 1
+#endif
+
+#if defined(__x86_64__)
+#define SS_X86_64 1
+#endif
+
+namespace ss {
+
+struct CpuFeatures {
+  bool ssse3 = false;
+  bool sse41 = false;
+  bool pclmul = false;
+};
+
+namespace impl {
+
+inline CpuFeatures DetectCpuFeatures() {
+  CpuFeatures features;
+
+#ifdef SS_X86
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    features.ssse3 = ecx & bit_SSSE3;
+    features.sse41 = ecx & bit_SSE4_1;
+    features.pclmul = ecx & bit_PCLMUL;
+  }
+#endif
+
+  return features;
+}
+
+}  // namespace impl
+
+// Features of the CPU we are running on, detected once on first use.
+inline const CpuFeatures& GetCpuFeatures() {
+  static const CpuFeatures kFeatures = impl::DetectCpuFeatures();
+  return kFeatures;
+}
+
+}  // namespace ss
@@ -0,0 +1,101 @@
+import argparse
+import struct
+import zlib
+
+import src.stuff_sack as ss
+
+# See src/dynamic/type_descriptors.cc for the format description.
+MAGIC = b'SSDB'
+VERSION = 1
+
+KIND_ENUM = 1
+KIND_BITFIELD = 2
+KIND_STRUCT = 3
+KIND_MESSAGE = 4
+
+# Primitives and SsHeader are implicit.
+NUM_BASE_TYPES = 12
+
+
+def _u8(value):
+  return struct.pack('>B', value)
+
+
+def _u16(value):
+  return struct.pack('>H', value)
+
+
+def _u32(value):
+  return struct.pack('>I', value)
+
+
+def _string(value):
+  encoded = value.encode()
+  if len(encoded) > 0xFFFF:
+    raise ValueError(f'Name "{value}" too long for descriptor blob.')
+  return _u16(len(encoded)) + encoded
+
+
+def _type_record(t, type_refs):
+  if isinstance(t, ss.Enum):
+    kind = KIND_ENUM
+  elif isinstance(t, ss.Bitfield):
+    kind = KIND_BITFIELD
+  elif isinstance(t, ss.Message):
+    kind = KIND_MESSAGE
+  elif isinstance(t, ss.Struct):
+    kind = KIND_STRUCT
+  else:
+    raise ValueError(f'Unexpected type {t.name}.')
+
+  s = _u8(kind) + _string(t.name) + _u32(t.uid) + _u32(t.packed_size)
+
+  if kind == KIND_ENUM:
+    s += _u32(len(t.values))
+    for value in t.values:
+      s += _string(value.name)
+  elif kind == KIND_BITFIELD:
+    s += _u32(len(t.fields))
+    for field in t.fields:
+      s += _string(field.name) + _u8(field.bits)
+  else:
+    # Implicit ss_header field is not stored.
+    fields = t.fields[1:] if kind == KIND_MESSAGE else t.fields
+    s += _u32(len(fields))
+    for field in fields:
+      lengths = field.type.all_lengths
+      s += _string(field.name) + _u32(type_refs[field.root_type.name]) + _u8(len(lengths))
+      for length in lengths:
+        s += _u32(length)
+
+  return s
+
+
+def to_blob(all_types):
+  all_types = list(all_types)
+  type_refs = {t.name: i for i, t in enumerate(all_types)}
+
+  body = b''.join(_type_record(t, type_refs) for t in all_types[NUM_BASE_TYPES:])
+
+  header_len = 16
+  trailer_len = 4
+  total_len = header_len + len(body) + trailer_len
+
+  blob = MAGIC + _u16(VERSION) + _u16(0) + _u32(len(all_types) - NUM_BASE_TYPES) + _u32(total_len)
+  blob += body
+
+  return blob + _u32(zlib.crc32(blob))
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Generate binary descriptor blob.')
+  parser.add_argument('--spec', required=True, help='YAML message specification.')
+  parser.add_argument('--output', required=True, help='Output blob file name.')
+  args = parser.parse_args()
+
+  with open(args.output, 'wb') as f:
+    f.write(to_blob(ss.parse_yaml(args.spec)))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,222 @@
+#include "src/dynamic/column_batch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "src/dynamic/packing.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace {
+
+// Packed values back to back, stride bytes apart.
+struct StridedRows {
+  const uint8_t *operator[](size_t row) const { return data + row * stride; }
+
+  const uint8_t *data;
+  size_t stride;
+};
+
+// One packed value per buffer.
+struct BufferRows {
+  const uint8_t *operator[](size_t row) const { return buffers[row]; }
+
+  const uint8_t *const *buffers;
+};
+
+// Fills rows [begin, end) of dest with the big endian T at offset of each row, in host order.
+template <typename T, typename Rows>
+void GatherColumn(const Rows& rows, size_t begin, size_t end, uint32_t offset, uint8_t *dest) {
+  for (size_t row = begin; row < end; ++row) {
+    const T value = UnpackBe<T>(rows[row] + offset);
+    memcpy(dest + row * sizeof(T), &value, sizeof(T));
+  }
+}
+
+// As GatherColumn, for one bitfield field (shift and mask) of the container C at offset.
+template <typename C, typename T, typename Rows>
+void GatherBitsColumn(const Rows& rows, size_t begin, size_t end, uint32_t offset, int shift,
+                      uint64_t mask, uint8_t *dest) {
+  for (size_t row = begin; row < end; ++row) {
+    const T value = static_cast<T>((UnpackBe<C>(rows[row] + offset) >> shift) & mask);
+    memcpy(dest + row * sizeof(T), &value, sizeof(T));
+  }
+}
+
+template <typename C, typename Rows>
+void GatherBitsColumn(const Rows& rows, size_t begin, size_t end, const FieldAccessor& accessor,
+                      uint8_t *dest) {
+  const uint32_t offset = accessor.offset();
+  const int shift = accessor.bit_offset();
+  const uint64_t mask = accessor.bit_mask();
+
+  switch (accessor.type().packed_size()) {
+    case 1:
+      GatherBitsColumn<C, uint8_t>(rows, begin, end, offset, shift, mask, dest);
+      return;
+    case 2:
+      GatherBitsColumn<C, uint16_t>(rows, begin, end, offset, shift, mask, dest);
+      return;
+    case 4:
+      GatherBitsColumn<C, uint32_t>(rows, begin, end, offset, shift, mask, dest);
+      return;
+    case 8:
+      GatherBitsColumn<C, uint64_t>(rows, begin, end, offset, shift, mask, dest);
+      return;
+  }
+  throw std::runtime_error("Incorrect bitfield field size.");
+}
+
+}  // namespace
+
+ColumnBatch::ColumnBatch(const TypeDescriptor& type) : type_{&type} {
+  if (!type.IsStruct()) throw std::runtime_error("ColumnBatch requires a struct type.");
+
+  AddColumns(type, "");
+  for (size_t i = 0; i < columns_.size(); ++i) index_.emplace(columns_[i].name(), i);
+}
+
+void ColumnBatch::AddColumns(const TypeDescriptor& type, const std::string& path) {
+  if (type.IsArray()) {
+    for (int i = 0; i < type.array_size(); ++i) {
+      AddColumns(type.array_elem_type(), path + "[" + std::to_string(i) + "]");
+    }
+    return;
+  }
+
+  if (type.IsStruct() || type.IsBitfield()) {
+    for (const FieldDescriptor *field : type.struct_fields()) {
+      AddColumns(field->type(), path.empty() ? std::string(field->name())
+                                             : path + "." + std::string(field->name()));
+    }
+    return;
+  }
+
+  columns_.push_back(Column(path, FieldAccessor::Compile(*type_, path)));
+}
+
+ColumnBatch::Column::Column(std::string name, FieldAccessor accessor)
+    : name_{std::move(name)}, accessor_{accessor}, storage_{Allocate(prim_type(), 0)} {}
+
+ColumnBatch::Column::Storage ColumnBatch::Column::Allocate(PrimType prim_type, size_t count) {
+  switch (prim_type) {
+    case PrimType::kUint8:
+      return std::make_unique<uint8_t[]>(count);
+    case PrimType::kUint16:
+      return std::make_unique<uint16_t[]>(count);
+    case PrimType::kUint32:
+      return std::make_unique<uint32_t[]>(count);
+    case PrimType::kUint64:
+      return std::make_unique<uint64_t[]>(count);
+    case PrimType::kInt8:
+      return std::make_unique<int8_t[]>(count);
+    case PrimType::kInt16:
+      return std::make_unique<int16_t[]>(count);
+    case PrimType::kInt32:
+      return std::make_unique<int32_t[]>(count);
+    case PrimType::kInt64:
+      return std::make_unique<int64_t[]>(count);
+    case PrimType::kBool:
+      return std::make_unique<bool[]>(count);
+    case PrimType::kFloat:
+      return std::make_unique<float[]>(count);
+    case PrimType::kDouble:
+      return std::make_unique<double[]>(count);
+  }
+  throw std::runtime_error("Invalid prim_type.");
+}
+
+const ColumnBatch::Column *ColumnBatch::operator[](std::string_view name) const {
+  const auto it = index_.find(name);
+  if (it == index_.end()) return nullptr;
+  return &columns_[it->second];
+}
+
+// Blocks of rows small enough to stay in cache while every column is gathered from them, so the
+// packed values are read from memory once and each inner loop is a fixed size load, swap and
+// store.
+template <typename Rows>
+void ColumnBatch::Gather(const Rows& rows) {
+  constexpr size_t kBlockRows = 256;
+
+  for (size_t begin = 0; begin < size_; begin += kBlockRows) {
+    const size_t end = std::min(size_, begin + kBlockRows);
+
+    for (Column& column : columns_) {
+      const FieldAccessor& accessor = column.accessor_;
+      uint8_t *dest = column.bytes_;
+
+      if (accessor.is_bitfield_field()) {
+        switch (accessor.container_type()) {
+          case PrimType::kUint8:
+            GatherBitsColumn<uint8_t>(rows, begin, end, accessor, dest);
+            break;
+          case PrimType::kUint16:
+            GatherBitsColumn<uint16_t>(rows, begin, end, accessor, dest);
+            break;
+          case PrimType::kUint32:
+            GatherBitsColumn<uint32_t>(rows, begin, end, accessor, dest);
+            break;
+          case PrimType::kUint64:
+            GatherBitsColumn<uint64_t>(rows, begin, end, accessor, dest);
+            break;
+          default:
+            throw std::runtime_error("Incorrect bitfield prim_type.");
+        }
+        continue;
+      }
+
+      // Wire bools may be any nonzero byte, so bool columns are normalized rather than copied.
+      if (accessor.prim_type() == PrimType::kBool) {
+        GatherColumn<bool>(rows, begin, end, accessor.offset(), dest);
+        continue;
+      }
+
+      switch (accessor.type().packed_size()) {
+        case 1:
+          GatherColumn<uint8_t>(rows, begin, end, accessor.offset(), dest);
+          break;
+        case 2:
+          GatherColumn<uint16_t>(rows, begin, end, accessor.offset(), dest);
+          break;
+        case 4:
+          GatherColumn<uint32_t>(rows, begin, end, accessor.offset(), dest);
+          break;
+        case 8:
+          GatherColumn<uint64_t>(rows, begin, end, accessor.offset(), dest);
+          break;
+        default:
+          throw std::runtime_error("Incorrect column size.");
+      }
+    }
+  }
+}
+
+void ColumnBatch::Decode(const uint8_t *data, size_t count) {
+  Resize(count);
+  Gather(StridedRows{data, static_cast<size_t>(type_->packed_size())});
+}
+
+void ColumnBatch::Decode(const uint8_t *const *buffers, size_t count) {
+  Resize(count);
+  Gather(BufferRows{buffers});
+}
+
+void ColumnBatch::Resize(size_t count) {
+  size_ = count;
+  for (Column& column : columns_) {
+    if (count > column.capacity_) {
+      column.storage_ = Column::Allocate(column.prim_type(), count);
+      column.bytes_ = column.StorageBytes();
+      column.capacity_ = count;
+    }
+    column.size_ = count;
+  }
+}
+
+}  // namespace dynamic
+}  // namespace ss
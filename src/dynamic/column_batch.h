@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/field_accessor.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+// Decodes a batch of packed values of one struct type into columns: one typed, contiguous array
+// per primitive, enum or bitfield field leaf, with nested structs and arrays flattened into
+// FieldAccessor paths such as "array_2d[1][2].field1" or "bitfield.field0".  Rows are decoded in
+// cache sized blocks, filling each column from the block with a load, swap and store specialized
+// for the column's size.
+//
+// The swap is deliberately scalar.  Staging each column of a block contiguously and swapping it
+// with SSSE3 shuffles measured slower (benchmark_column_batch), because the strided loads and the
+// per-column stores dominate, not the swap.
+class ColumnBatch {
+ public:
+  using PrimType = TypeDescriptor::PrimType;
+
+  class Column {
+   public:
+    const std::string& name() const { return name_; }
+    const FieldAccessor& accessor() const { return accessor_; }
+    PrimType prim_type() const { return accessor_.prim_type(); }
+
+    // T must match prim_type() exactly, otherwise throws std::bad_variant_access.
+    template <typename T>
+    Span<const T> values() const {
+      return Span<const T>(std::get<std::unique_ptr<T[]>>(storage_).get(), size_);
+    }
+
+   private:
+    friend class ColumnBatch;
+
+    // An array of prim_type()'s C++ type, so values<T>() reads actual T objects; rows are written
+    // through its bytes.
+    using Storage =
+        std::variant<std::unique_ptr<uint8_t[]>, std::unique_ptr<uint16_t[]>,
+                     std::unique_ptr<uint32_t[]>, std::unique_ptr<uint64_t[]>,
+                     std::unique_ptr<int8_t[]>, std::unique_ptr<int16_t[]>,
+                     std::unique_ptr<int32_t[]>, std::unique_ptr<int64_t[]>,
+                     std::unique_ptr<bool[]>, std::unique_ptr<float[]>, std::unique_ptr<double[]>>;
+
+    Column(std::string name, FieldAccessor accessor);
+
+    static Storage Allocate(PrimType prim_type, size_t count);
+
+    uint8_t *StorageBytes() {
+      return std::visit([](auto& array) { return reinterpret_cast<uint8_t *>(array.get()); },
+                        storage_);
+    }
+
+    std::string name_;
+    FieldAccessor accessor_;
+    Storage storage_;
+    // StorageBytes(), kept so decoding does not visit storage_.
+    uint8_t *bytes_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+  };
+
+  // Throws std::runtime_error if type is not a struct.
+  explicit ColumnBatch(const TypeDescriptor& type);
+
+  // Replaces the batch with count values packed back to back, type().packed_size() bytes apart.
+  void Decode(const uint8_t *data, size_t count);
+
+  // Replaces the batch with one value from each of count buffers.
+  void Decode(const uint8_t *const *buffers, size_t count);
+
+  const TypeDescriptor& type() const { return *type_; }
+
+  // Number of rows decoded.
+  size_t size() const { return size_; }
+
+  const std::vector<Column>& columns() const { return columns_; }
+
+  // nullptr if there is no column with that name.
+  const Column *operator[](std::string_view name) const;
+
+  // Throws std::out_of_range if there is no column with that name.
+  template <typename T>
+  Span<const T> values(std::string_view name) const {
+    const Column *column = (*this)[name];
+    if (!column) throw std::out_of_range("No column \"" + std::string(name) + "\".");
+    return column->values<T>();
+  }
+
+ private:
+  void AddColumns(const TypeDescriptor& type, const std::string& path);
+  void Resize(size_t count);
+
+  // Rows is indexed by row and gives a pointer to that packed value.
+  template <typename Rows>
+  void Gather(const Rows& rows);
+
+  const TypeDescriptor *type_;
+  std::vector<Column> columns_;
+  std::unordered_map<std::string_view, size_t> index_;
+  size_t size_ = 0;
+};
+
+}  // namespace dynamic
+}  // namespace ss
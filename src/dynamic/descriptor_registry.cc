@@ -0,0 +1,113 @@
+#include "src/dynamic/descriptor_registry.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace ss {
+namespace dynamic {
+
+DescriptorRegistry::Snapshot::Snapshot(std::vector<Spec> specs) : specs_(std::move(specs)) {
+  for (const Spec& spec : specs_) {
+    for (const auto& type_pair : spec.types->types()) {
+      const TypeDescriptor *type = type_pair.second;
+      if (!types_.emplace(type->uid(), type).second) continue;
+
+      if (type->type() == TypeDescriptor::Type::kStruct && type->struct_is_message()) {
+        messages_.push_back(type);
+        message_uids_.push_back(type->uid());
+      }
+    }
+  }
+
+  uid_table_ = perfect_hash::Find(message_uids_);
+
+  messages_.push_back(nullptr);
+  message_uids_.push_back(0);
+}
+
+const TypeDescriptor *DescriptorRegistry::Snapshot::operator[](std::string_view name) const {
+  for (const Spec& spec : specs_) {
+    const TypeDescriptor *type = (*spec.types)[name];
+    if (type) return type;
+  }
+  return nullptr;
+}
+
+DescriptorRegistry::DescriptorRegistry() : current_owner_(new Snapshot({})) {
+  current_.store(current_owner_.get());
+}
+
+DescriptorRegistry::~DescriptorRegistry() = default;
+
+DescriptorRegistry::ReadGuard DescriptorRegistry::Read() const {
+  // The increment must be ordered before loading current_ (all seq_cst) so that a writer which
+  // swaps current_ afterwards is guaranteed to see this reader.
+  std::atomic<int64_t>& readers = readers_[epoch_.load() & 1].count;
+  readers.fetch_add(1);
+  return ReadGuard(current_.load(), &readers);
+}
+
+std::shared_ptr<const DescriptorRegistry::Snapshot> DescriptorRegistry::ReadShared() const {
+  // The guard keeps the writer's reference alive while this one is taken.
+  const ReadGuard guard = Read();
+  return guard->shared_from_this();
+}
+
+void DescriptorRegistry::Publish(std::string_view name, DescriptorBuilder types) {
+  Publish(name, std::make_shared<const DescriptorBuilder>(std::move(types)));
+}
+
+void DescriptorRegistry::Publish(std::string_view name,
+                                 std::shared_ptr<const DescriptorBuilder> types) {
+  if (!types) throw std::runtime_error("Cannot publish null spec.");
+
+  std::lock_guard<std::mutex> lock(write_mutex_);
+
+  std::vector<Snapshot::Spec> specs = current_.load()->specs();
+  auto spec_it = std::find_if(specs.begin(), specs.end(),
+                              [&](const Snapshot::Spec& spec) { return spec.name == name; });
+  if (spec_it == specs.end()) {
+    specs.push_back({std::string(name), std::move(types)});
+  } else {
+    spec_it->types = std::move(types);
+  }
+
+  Swap(std::move(specs));
+}
+
+bool DescriptorRegistry::Remove(std::string_view name) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+
+  std::vector<Snapshot::Spec> specs = current_.load()->specs();
+  auto spec_it = std::find_if(specs.begin(), specs.end(),
+                              [&](const Snapshot::Spec& spec) { return spec.name == name; });
+  if (spec_it == specs.end()) return false;
+  specs.erase(spec_it);
+
+  Swap(std::move(specs));
+  return true;
+}
+
+void DescriptorRegistry::Swap(std::vector<Snapshot::Spec> specs) {
+  // Build fully before publishing; throws leave the current snapshot in place.
+  std::shared_ptr<const Snapshot> next(new Snapshot(std::move(specs)));
+  current_.store(next.get());
+  const std::shared_ptr<const Snapshot> prev = std::exchange(current_owner_, std::move(next));
+  Synchronize();
+}
+
+void DescriptorRegistry::Synchronize() {
+  // A reader that still holds the previous snapshot registered before the exchange, on one of the
+  // two counters.  Flip the epoch so new readers go to the other counter and wait for the old one
+  // to drain, then repeat for the other counter.  Readers that raced with a flip and registered on
+  // a drained counter loaded current_ after the exchange and never see the previous snapshot.
+  for (int phase = 0; phase < 2; ++phase) {
+    const uint64_t epoch = epoch_.fetch_add(1);
+    while (readers_[epoch & 1].count.load() != 0) std::this_thread::yield();
+  }
+}
+
+}  // namespace dynamic
+}  // namespace ss
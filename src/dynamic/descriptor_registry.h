@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "src/dynamic/type_descriptors.h"
+#include "src/perfect_hash.h"
+
+namespace ss {
+namespace dynamic {
+
+// Merges several specs (e.g. from different firmware versions) into one set of types keyed by
+// UID, and allows specs to be added, replaced or removed while other threads are decoding.
+//
+// Readers never block: Read() pins the current snapshot with a single atomic increment.  Writers
+// swap in a new snapshot and then wait for a grace period (a two phase epoch flip, as in userspace
+// RCU) before freeing the old one.  Writers are serialized among themselves.
+class DescriptorRegistry {
+ public:
+  using UidMap = std::unordered_map<uint32_t, const TypeDescriptor *>;
+
+  // Immutable merged view of the published specs.
+  class Snapshot : public std::enable_shared_from_this<Snapshot> {
+   public:
+    struct Spec {
+      std::string name;
+      std::shared_ptr<const DescriptorBuilder> types;
+    };
+
+    // Specs in publish order.
+    const std::vector<Spec>& specs() const { return specs_; }
+
+    // Every type of every spec, deduplicated by UID.  Equal UIDs imply equal layouts, so the
+    // descriptor from the first spec containing a UID is used.
+    const UidMap& types() const { return types_; }
+
+    // Names are not unique across specs; returns the first match in publish order.
+    const TypeDescriptor *operator[](std::string_view name) const;
+
+    const TypeDescriptor *LookupTypeFromUid(uint32_t uid) const {
+      const auto& type_it = types_.find(uid);
+      if (type_it == types_.end()) return nullptr;
+      return type_it->second;
+    }
+
+    const TypeDescriptor *LookupMsgFromUid(uint32_t msg_uid) const {
+      const uint32_t i = uid_table_.Lookup(msg_uid);
+      return msg_uid == message_uids_[i] ? messages_[i] : nullptr;
+    }
+
+   private:
+    friend class DescriptorRegistry;
+
+    explicit Snapshot(std::vector<Spec> specs);
+
+    std::vector<Spec> specs_;
+    UidMap types_;
+
+    // Messages followed by a nullptr / 0 entry that empty hash slots point at.
+    perfect_hash::Table uid_table_;
+    std::vector<const TypeDescriptor *> messages_;
+    std::vector<uint32_t> message_uids_;
+  };
+
+  // Pins a snapshot for as long as it is alive.  Descriptors obtained through it (and dynamic
+  // types built on them) must not outlive the guard.
+  class ReadGuard {
+   public:
+    ReadGuard(ReadGuard&& other) noexcept : snapshot_(other.snapshot_), readers_(other.readers_) {
+      other.readers_ = nullptr;
+    }
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+    ReadGuard& operator=(ReadGuard&&) = delete;
+
+    ~ReadGuard() {
+      if (readers_) readers_->fetch_sub(1);
+    }
+
+    const Snapshot& operator*() const { return *snapshot_; }
+    const Snapshot *operator->() const { return snapshot_; }
+
+   private:
+    friend class DescriptorRegistry;
+
+    ReadGuard(const Snapshot *snapshot, std::atomic<int64_t> *readers)
+        : snapshot_(snapshot), readers_(readers) {}
+
+    const Snapshot *snapshot_;
+    std::atomic<int64_t> *readers_;
+  };
+
+  DescriptorRegistry();
+  ~DescriptorRegistry();
+
+  DescriptorRegistry(const DescriptorRegistry&) = delete;
+  DescriptorRegistry& operator=(const DescriptorRegistry&) = delete;
+
+  // Lock-free.
+  ReadGuard Read() const;
+
+  // The current snapshot, kept alive by reference count rather than pinned: a replaced snapshot
+  // is freed when its last shared_ptr goes, and holding one never blocks Publish() or Remove().
+  // For long lived readers such as a MessageDecoder; costs one more atomic increment than Read().
+  std::shared_ptr<const Snapshot> ReadShared() const;
+
+  // Add a spec, or replace the spec with the same name.  Returns once no ReadGuard can observe the
+  // previous snapshot, so it must not be called while the calling thread holds a ReadGuard.
+  void Publish(std::string_view name, DescriptorBuilder types);
+  void Publish(std::string_view name, std::shared_ptr<const DescriptorBuilder> types);
+
+  // Returns false if no spec has this name.  Same blocking behavior as Publish().
+  bool Remove(std::string_view name);
+
+ private:
+  void Swap(std::vector<Snapshot::Spec> specs);
+  void Synchronize();
+
+  // Readers register on the counter selected by the epoch's low bit.
+  struct alignas(64) ReaderCount {
+    std::atomic<int64_t> count{0};
+  };
+
+  mutable ReaderCount readers_[2];
+  std::atomic<uint64_t> epoch_{0};
+  // Owned by current_owner_ (guarded by write_mutex_) and by any ReadShared() pointers.
+  std::atomic<const Snapshot *> current_;
+  std::shared_ptr<const Snapshot> current_owner_;
+
+  std::mutex write_mutex_;
+};
+
+}  // namespace dynamic
+}  // namespace ss
@@ -1,21 +1,28 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "src/cpu_features.h"
 #include "src/dynamic/packing.h"
 #include "src/dynamic/type_descriptors.h"
 
-// These dynamic types were written with expediency as the primary requirement.  They leave a lot to
-// be desired in terms of efficiency, speed, and likely ergonomics.  However they should work as
-// advertised (see how I set the bar low?) in the corner use-cases in which they are required.
+// Runtime typed values for specs known only at run time.  A DynamicStruct or DynamicArray keeps its
+// whole value, nested structs and arrays included, in one impl::ValueBuffer laid out per the
+// descriptor's value offsets, and Unpack / Pack run the descriptor's precompiled plans over it.
 
 namespace ss {
 namespace dynamic {
@@ -23,159 +30,490 @@ namespace dynamic {
 class DynamicArray;
 class DynamicStruct;
 
+// Minimal stand-in for C++20's std::span: a non-owning view of size contiguous T.
+template <typename T>
+class Span {
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using iterator = T *;
+
+  constexpr Span() = default;
+  constexpr Span(T *data, size_t size) : data_{data}, size_{size} {}
+
+  // Span<T> converts to Span<const T>.
+  template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+  constexpr Span(const Span<U>& other) : data_{other.data()}, size_{other.size()} {}
+
+  constexpr T *data() const { return data_; }
+  constexpr size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+
+  constexpr T& operator[](size_t i) const { return data_[i]; }
+  constexpr T& front() const { return data_[0]; }
+  constexpr T& back() const { return data_[size_ - 1]; }
+
+  constexpr iterator begin() const { return data_; }
+  constexpr iterator end() const { return data_ + size_; }
+
+ private:
+  T *data_ = nullptr;
+  size_t size_ = 0;
+};
+
 namespace impl {
 
 template <typename T>
-class Box {
- public:
-  template <typename... Args>
-  static Box<T> Make(Args&&...args) {
-    return Box<T>(std::make_unique<T>(std::forward<Args>(args)...));
-  }
+inline constexpr bool is_dynamic_v =
+    std::is_same_v<T, DynamicStruct> || std::is_same_v<T, DynamicArray>;
 
-  Box() = delete;
+template <typename T>
+static inline T LoadValue(const uint8_t *data) {
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
 
-  Box(const T& val) : ptr_(std::make_unique<T>(val)) {}
-  Box(T&& val) : ptr_(std::make_unique<T>(std::move(val))) {}
+template <typename T>
+static inline void StoreValue(T value, uint8_t *data) {
+  memcpy(data, &value, sizeof(value));
+}
 
-  Box(const Box& other) : Box(*other.ptr_) {}
-  Box(Box&& other) : ptr_(std::move(other.ptr_)) {}
+// Loads a value of prim_type from the unpacked layout and static_casts it to T.
+template <typename T>
+static inline T LoadConvert(TypeDescriptor::PrimType prim_type, const uint8_t *data) {
+  using PrimType = TypeDescriptor::PrimType;
 
-  Box& operator=(const Box& other) {
-    ptr_ = std::make_unique<T>(*other.ptr_);
-    return *this;
+  switch (prim_type) {
+    case PrimType::kUint8:
+      return static_cast<T>(LoadValue<uint8_t>(data));
+    case PrimType::kUint16:
+      return static_cast<T>(LoadValue<uint16_t>(data));
+    case PrimType::kUint32:
+      return static_cast<T>(LoadValue<uint32_t>(data));
+    case PrimType::kUint64:
+      return static_cast<T>(LoadValue<uint64_t>(data));
+    case PrimType::kInt8:
+      return static_cast<T>(LoadValue<int8_t>(data));
+    case PrimType::kInt16:
+      return static_cast<T>(LoadValue<int16_t>(data));
+    case PrimType::kInt32:
+      return static_cast<T>(LoadValue<int32_t>(data));
+    case PrimType::kInt64:
+      return static_cast<T>(LoadValue<int64_t>(data));
+    case PrimType::kBool:
+      return static_cast<T>(LoadValue<bool>(data));
+    case PrimType::kFloat:
+      return static_cast<T>(LoadValue<float>(data));
+    case PrimType::kDouble:
+      return static_cast<T>(LoadValue<double>(data));
   }
 
-  Box& operator=(Box&& other) {
-    ptr_ = std::move(other.ptr_);
-    return *this;
+  throw std::runtime_error("Invalid prim_type.");
+}
+
+template <typename T>
+static inline T LoadConvertValue(const uint8_t *data, const TypeDescriptor& type) {
+  if (type.IsArray() || type.IsStruct() || type.IsBitfield()) throw std::bad_variant_access();
+  return LoadConvert<T>(type.prim_type(), data);
+}
+
+// A run of count big endian Ts to host order.  Multi-byte runs go through the SSSE3 byte swap
+// when ssse3 is set; GCC does not vectorize the scalar loop itself.
+template <typename T>
+static inline void UnpackRun(const uint8_t *src, uint8_t *dest, uint32_t count,
+                             [[maybe_unused]] bool ssse3) {
+  uint32_t i = 0;
+#ifdef SS_X86_64
+  if constexpr (sizeof(T) > 1) {
+    if (ssse3) i = ByteSwapRunSsse3<sizeof(T)>(src, dest, count);
   }
+#endif
+  for (; i < count; ++i) {
+    StoreValue(UnpackBe<T>(src + i * sizeof(T)), dest + i * sizeof(T));
+  }
+}
 
-  T& operator*() { return *ptr_; }
-  const T& operator*() const { return *ptr_; }
+// Bitfield containers and bitfield fields are always unsigned.
+static inline uint64_t LoadBits(TypeDescriptor::PrimType prim_type, const uint8_t *src) {
+  using PrimType = TypeDescriptor::PrimType;
 
-  T *operator->() { return ptr_.get(); }
-  const T *operator->() const { return ptr_.get(); }
+  switch (prim_type) {
+    case PrimType::kUint8:
+      return LoadValue<uint8_t>(src);
+    case PrimType::kUint16:
+      return LoadValue<uint16_t>(src);
+    case PrimType::kUint32:
+      return LoadValue<uint32_t>(src);
+    case PrimType::kUint64:
+      return LoadValue<uint64_t>(src);
+    default:
+      throw std::runtime_error("Incorrect bitfield field prim_type.");
+  }
+}
 
-  T *get() { return ptr_.get(); }
-  const T *get() const { return ptr_.get(); }
+static inline void StoreBits(TypeDescriptor::PrimType prim_type, uint64_t value, uint8_t *dest) {
+  using PrimType = TypeDescriptor::PrimType;
 
- private:
-  Box(std::unique_ptr<T>&& ptr) : ptr_(std::move(ptr)) {}
+  switch (prim_type) {
+    case PrimType::kUint8:
+      StoreValue(static_cast<uint8_t>(value), dest);
+      return;
+    case PrimType::kUint16:
+      StoreValue(static_cast<uint16_t>(value), dest);
+      return;
+    case PrimType::kUint32:
+      StoreValue(static_cast<uint32_t>(value), dest);
+      return;
+    case PrimType::kUint64:
+      StoreValue(value, dest);
+      return;
+    default:
+      throw std::runtime_error("Incorrect bitfield field prim_type.");
+  }
+}
 
-  std::unique_ptr<T> ptr_;
-};
+static inline uint64_t UnpackContainer(TypeDescriptor::PrimType container_type,
+                                       const uint8_t *src) {
+  using PrimType = TypeDescriptor::PrimType;
 
-template <typename T>
-struct is_dynamic : std::false_type {};
-template <>
-struct is_dynamic<Box<DynamicStruct>> : std::true_type {};
-template <>
-struct is_dynamic<Box<DynamicArray>> : std::true_type {};
+  switch (container_type) {
+    case PrimType::kUint8:
+      return UnpackBe<uint8_t>(src);
+    case PrimType::kUint16:
+      return UnpackBe<uint16_t>(src);
+    case PrimType::kUint32:
+      return UnpackBe<uint32_t>(src);
+    case PrimType::kUint64:
+      return UnpackBe<uint64_t>(src);
+    default:
+      throw std::runtime_error("Incorrect bitfield prim_type.");
+  }
+}
+
+static inline void PackContainer(TypeDescriptor::PrimType container_type, uint64_t raw,
+                                 uint8_t *dest) {
+  using PrimType = TypeDescriptor::PrimType;
+
+  switch (container_type) {
+    case PrimType::kUint8:
+      PackBe(static_cast<uint8_t>(raw), dest);
+      return;
+    case PrimType::kUint16:
+      PackBe(static_cast<uint16_t>(raw), dest);
+      return;
+    case PrimType::kUint32:
+      PackBe(static_cast<uint32_t>(raw), dest);
+      return;
+    case PrimType::kUint64:
+      PackBe(raw, dest);
+      return;
+    default:
+      throw std::runtime_error("Incorrect bitfield prim_type.");
+  }
+}
 
-using AnyField = std::variant<uint8_t, uint16_t, uint32_t, uint64_t, int8_t, int16_t, int32_t,
-                              int64_t, bool, float, double, Box<DynamicArray>, Box<DynamicStruct>>;
+// Extracts all fields of one bitfield, ops[0, ops->count), from its unpacked container.
+static inline void UnpackBitfieldFields(uint64_t raw, const UnpackOp *ops, uint8_t *values) {
+  for (uint32_t i = 0; i < ops->count; ++i) {
+    const UnpackOp& op = ops[i];
+    StoreBits(op.prim_type, ExtractBits(raw, op.mask, op.bit_offset), values + op.dest_offset);
+  }
+}
 
-static inline AnyField MakeAnyField(const TypeDescriptor& field_type_descriptor) {
-  using Type = TypeDescriptor::Type;
+// Gathers all fields of one bitfield into its container.
+static inline uint64_t PackBitfieldFields(const UnpackOp *ops, const uint8_t *values) {
+  uint64_t raw = 0;
+  for (uint32_t i = 0; i < ops->count; ++i) {
+    const UnpackOp& op = ops[i];
+    raw |= DepositBits(LoadBits(op.prim_type, values + op.dest_offset), op.mask, op.bit_offset);
+  }
+  return raw;
+}
+
+// Runs a type's UnpackPlan, writing into values laid out per TypeDescriptor::value_size().
+// features selects the run code path; tests pass their own to cover the portable one.
+static inline void ExecuteUnpackPlan(const UnpackPlan& plan, const uint8_t *data, uint8_t *values,
+                                     const CpuFeatures& features = GetCpuFeatures()) {
   using PrimType = TypeDescriptor::PrimType;
 
-  switch (field_type_descriptor.type()) {
-    case Type::kPrimitive:
-    case Type::kEnum:
-      switch (field_type_descriptor.prim_type()) {
+  const bool ssse3 = features.ssse3;
+
+  for (const UnpackOp *it = plan.begin(); it != plan.end();) {
+    const UnpackOp& op = *it;
+    const uint8_t *src = data + op.src_offset;
+    uint8_t *dest = values + op.dest_offset;
+
+    if (op.kind == UnpackOp::Kind::kPrimitive) {
+      switch (op.prim_type) {
         case PrimType::kUint8:
-          return AnyField(std::in_place_type<uint8_t>);
+          UnpackRun<uint8_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kUint16:
-          return AnyField(std::in_place_type<uint16_t>);
+          UnpackRun<uint16_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kUint32:
-          return AnyField(std::in_place_type<uint32_t>);
+          UnpackRun<uint32_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kUint64:
-          return AnyField(std::in_place_type<uint64_t>);
+          UnpackRun<uint64_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kInt8:
-          return AnyField(std::in_place_type<int8_t>);
+          UnpackRun<int8_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kInt16:
-          return AnyField(std::in_place_type<int16_t>);
+          UnpackRun<int16_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kInt32:
-          return AnyField(std::in_place_type<int32_t>);
+          UnpackRun<int32_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kInt64:
-          return AnyField(std::in_place_type<int64_t>);
+          UnpackRun<int64_t>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kBool:
-          return AnyField(std::in_place_type<bool>);
+          UnpackRun<bool>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kFloat:
-          return AnyField(std::in_place_type<float>);
+          UnpackRun<float>(src, dest, op.count, ssse3);
+          break;
         case PrimType::kDouble:
-          return AnyField(std::in_place_type<double>);
+          UnpackRun<double>(src, dest, op.count, ssse3);
+          break;
       }
-    case Type::kArray:
-      return Box<DynamicArray>::Make(field_type_descriptor);
-    case Type::kStruct:
-    case Type::kBitfield:
-      return Box<DynamicStruct>::Make(field_type_descriptor);
+      ++it;
+      continue;
+    }
+
+    // One container read for all the bitfield's fields.
+    const uint64_t raw = UnpackContainer(op.container_type, src);
+    UnpackBitfieldFields(raw, it, values);
+    it += op.count;
   }
+}
 
-  return {};
+// Inverse of UnpackRun.
+template <typename T>
+static inline void PackRun(const uint8_t *src, uint8_t *dest, uint32_t count,
+                           [[maybe_unused]] bool ssse3) {
+  uint32_t i = 0;
+#ifdef SS_X86_64
+  if constexpr (sizeof(T) > 1) {
+    if (ssse3) i = ByteSwapRunSsse3<sizeof(T)>(src, dest, count);
+  }
+#endif
+  for (; i < count; ++i) {
+    PackBe(LoadValue<T>(src + i * sizeof(T)), dest + i * sizeof(T));
+  }
 }
 
-static inline void UnpackToAnyField(AnyField& any_field, const uint8_t *data,
-                                    TypeDescriptor::PrimType prim_type) {
-  switch (prim_type) {
-    case TypeDescriptor::PrimType::kUint8:
-      std::get<uint8_t>(any_field) = UnpackBe<uint8_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kUint16:
-      std::get<uint16_t>(any_field) = UnpackBe<uint16_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kUint32:
-      std::get<uint32_t>(any_field) = UnpackBe<uint32_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kUint64:
-      std::get<uint64_t>(any_field) = UnpackBe<uint64_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kInt8:
-      std::get<int8_t>(any_field) = UnpackBe<int8_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kInt16:
-      std::get<int16_t>(any_field) = UnpackBe<int16_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kInt32:
-      std::get<int32_t>(any_field) = UnpackBe<int32_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kInt64:
-      std::get<int64_t>(any_field) = UnpackBe<int64_t>(data);
-      break;
-    case TypeDescriptor::PrimType::kBool:
-      std::get<bool>(any_field) = UnpackBe<bool>(data);
-      break;
-    case TypeDescriptor::PrimType::kFloat:
-      std::get<float>(any_field) = UnpackBe<float>(data);
-      break;
-    case TypeDescriptor::PrimType::kDouble:
-      std::get<double>(any_field) = UnpackBe<double>(data);
-      break;
+// Runs a type's UnpackPlan in reverse, packing values laid out per TypeDescriptor::value_size()
+// into data.  Bitfield bits not covered by a field are packed as zero.
+static inline void ExecutePackPlan(const UnpackPlan& plan, const uint8_t *values, uint8_t *data,
+                                   const CpuFeatures& features = GetCpuFeatures()) {
+  using PrimType = TypeDescriptor::PrimType;
+
+  const bool ssse3 = features.ssse3;
+
+  for (const UnpackOp *it = plan.begin(); it != plan.end();) {
+    const UnpackOp& op = *it;
+    const uint8_t *src = values + op.dest_offset;
+    uint8_t *dest = data + op.src_offset;
+
+    if (op.kind == UnpackOp::Kind::kPrimitive) {
+      switch (op.prim_type) {
+        case PrimType::kUint8:
+          PackRun<uint8_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kUint16:
+          PackRun<uint16_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kUint32:
+          PackRun<uint32_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kUint64:
+          PackRun<uint64_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kInt8:
+          PackRun<int8_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kInt16:
+          PackRun<int16_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kInt32:
+          PackRun<int32_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kInt64:
+          PackRun<int64_t>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kBool:
+          PackRun<bool>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kFloat:
+          PackRun<float>(src, dest, op.count, ssse3);
+          break;
+        case PrimType::kDouble:
+          PackRun<double>(src, dest, op.count, ssse3);
+          break;
+      }
+      ++it;
+      continue;
+    }
+
+    // One container write for all the bitfield's fields.
+    const uint64_t raw = PackBitfieldFields(it, values);
+    PackContainer(op.container_type, raw, dest);
+    it += op.count;
   }
 }
 
+// Storage for a value in its unpacked layout: either one zero initialized allocation from a
+// memory resource owned by a top level DynamicStruct / DynamicArray, or an alias into an enclosing
+// value.  Both remember the top level value's resource, which also backs the handles of nested
+// values.  Moving an owned buffer leaves the source empty but keeping its resource, so it can be
+// assigned to again; moving an alias copies the alias.
+class ValueBuffer {
+ public:
+  ValueBuffer(const TypeDescriptor& type, std::pmr::memory_resource *resource)
+      : resource_{resource}, size_{type.value_size()}, align_{type.value_align()}, owned_{true} {
+    data_ = static_cast<uint8_t *>(resource_->allocate(size_, align_));
+    memset(data_, 0, size_);
+  }
+
+  ValueBuffer(uint8_t *alias, std::pmr::memory_resource *resource)
+      : data_{alias}, resource_{resource} {}
+
+  ~ValueBuffer() { Release(); }
+
+  ValueBuffer(const ValueBuffer&) = delete;
+  ValueBuffer& operator=(const ValueBuffer&) = delete;
+
+  ValueBuffer(ValueBuffer&& other) noexcept
+      : data_{other.data_},
+        resource_{other.resource_},
+        size_{other.size_},
+        align_{other.align_},
+        owned_{std::exchange(other.owned_, false)} {
+    if (owned_) other.data_ = nullptr;
+  }
+
+  ValueBuffer& operator=(ValueBuffer&& other) noexcept {
+    if (this == &other) return *this;
+    Release();
+    data_ = other.data_;
+    resource_ = other.resource_;
+    size_ = other.size_;
+    align_ = other.align_;
+    owned_ = std::exchange(other.owned_, false);
+    if (owned_) other.data_ = nullptr;
+    return *this;
+  }
+
+  // A null data, from a moved from value, copies to an empty buffer.
+  static ValueBuffer Copy(const TypeDescriptor& type, const uint8_t *data,
+                          std::pmr::memory_resource *resource) {
+    if (!data) return ValueBuffer(nullptr, resource);
+    ValueBuffer buffer(type, resource);
+    memcpy(buffer.data(), data, type.value_size());
+    return buffer;
+  }
+
+  bool owned() const { return owned_; }
+
+  // Only a moved from buffer is empty.
+  bool empty() const { return data_ == nullptr; }
+
+  uint8_t *data() const { return data_; }
+  std::pmr::memory_resource *resource() const { return resource_; }
+
+ private:
+  void Release() {
+    if (owned_) resource_->deallocate(data_, size_, align_);
+  }
+
+  uint8_t *data_ = nullptr;
+  std::pmr::memory_resource *resource_ = nullptr;
+  size_t size_ = 0;
+  size_t align_ = 0;
+  bool owned_ = false;
+};
+
+class Handles;
+
+inline bool IsAggregate(const TypeDescriptor& type) {
+  return type.IsStruct() || type.IsBitfield() || type.IsArray();
+}
+
+template <typename T>
+T& ValueAt(uint8_t *data, const TypeDescriptor& type);
+
 }  // namespace impl
 
+// A struct (or bitfield) value stored in one contiguous buffer laid out per the descriptor's
+// value_size().  Nested structs and arrays are stored inline, so a decoded message is a single
+// allocation, copies are a single memcpy, and fields are constant offset loads.
+//
+// Get returns a nested struct or array as a reference to a handle owned by this value that aliases
+// its storage, so writes through the reference reach this value, and copying it makes an
+// independent value.  The handles for one level are created together the first time one of them
+// is accessed, from this value's resource, even through a const accessor.  Concurrent const access
+// to nested values is therefore only safe when that resource is thread-safe (e.g. the default
+// new_delete_resource() or a synchronized_pool_resource), not with a monotonic_buffer_resource or
+// unsynchronized_pool_resource.
 class DynamicStruct {
  public:
-  DynamicStruct(const TypeDescriptor& descriptor) : descriptor_{descriptor} {
-    for (const std::unique_ptr<const FieldDescriptor>& field : descriptor.struct_fields()) {
-      fields_.emplace(field.get(), impl::MakeAnyField(field->type()));
+  DynamicStruct(const TypeDescriptor& descriptor,
+                std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : descriptor_{&descriptor}, values_{descriptor, resource} {}
+
+  // Copies are always independent of the source, even when the source is a nested value, and
+  // allocate from resource.  Moving a top level value moves its buffer along with the resource it
+  // came from and leaves the source empty: it may then only be copied, assigned to or destroyed,
+  // and copies of it are empty too.  Moving a nested value makes another handle aliasing the same
+  // storage.
+  DynamicStruct(const DynamicStruct& other,
+                std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : descriptor_{other.descriptor_},
+        values_{impl::ValueBuffer::Copy(*descriptor_, other.values_.data(), resource)} {}
+
+  DynamicStruct(DynamicStruct&& other) noexcept
+      : descriptor_{other.descriptor_},
+        values_{std::move(other.values_)},
+        handles_{values_.owned() ? other.handles_.exchange(nullptr) : nullptr} {}
+
+  ~DynamicStruct();
+
+  // Assigning to a nested value writes through to it, and the source must be of the same type.
+  DynamicStruct& operator=(const DynamicStruct& other) {
+    if (this == &other) return *this;
+    Assign(*other.descriptor_, other.values_.data());
+    return *this;
+  }
+
+  DynamicStruct& operator=(DynamicStruct&& other) {
+    if (this == &other) return *this;
+    if (other.values_.owned() && (values_.owned() || values_.empty())) {
+      ResetHandles();
+      descriptor_ = other.descriptor_;
+      values_ = std::move(other.values_);
+      handles_ = other.handles_.exchange(nullptr);
+      return *this;
     }
+    return *this = static_cast<const DynamicStruct&>(other);
   }
 
   void Unpack(const uint8_t *data);
 
+  // Writes descriptor().packed_size() bytes.
+  void Pack(uint8_t *data) const;
+
   template <typename T>
   T& Get(const FieldDescriptor& field_descriptor) {
-    impl::AnyField& field = fields_.at(&field_descriptor);
-
-    if constexpr (std::is_same_v<T, DynamicStruct> || std::is_same_v<T, DynamicArray>) {
-      return *std::get<impl::Box<T>>(field);
+    const FieldDescriptor& field = AtField(field_descriptor);
+    if constexpr (impl::is_dynamic_v<T>) {
+      if (!impl::IsAggregate(field.type())) throw std::bad_variant_access();
+      return GetHandle<T>(field.ordinal());
     } else {
-      return std::get<T>(field);
+      return impl::ValueAt<T>(FieldData(field), field.type());
     }
   }
 
@@ -186,7 +524,7 @@ class DynamicStruct {
 
   template <typename T>
   T& Get(std::string_view field_name) {
-    return Get<T>(*descriptor_[field_name]);
+    return Get<T>(AtField(field_name));
   }
 
   template <typename T>
@@ -196,16 +534,8 @@ class DynamicStruct {
 
   template <typename T>
   T *GetIf(const FieldDescriptor& field_descriptor) {
-    const auto& field_it = fields_.find(&field_descriptor);
-    if (field_it == fields_.end()) return nullptr;
-
-    impl::AnyField& field = field_it->second;
-
-    if constexpr (std::is_same_v<T, DynamicStruct> || std::is_same_v<T, DynamicArray>) {
-      return *std::get<impl::Box<T>>(field);
-    } else {
-      return &std::get<T>(field);
-    }
+    if (!HasField(field_descriptor)) return nullptr;
+    return &Get<T>(field_descriptor);
   }
 
   template <typename T>
@@ -215,7 +545,7 @@ class DynamicStruct {
 
   template <typename T>
   T *GetIf(std::string_view field_name) {
-    const FieldDescriptor *field = descriptor_[field_name];
+    const FieldDescriptor *field = (*descriptor_)[field_name];
     if (!field) return nullptr;
     return GetIf<T>(*field);
   }
@@ -227,180 +557,122 @@ class DynamicStruct {
 
   template <typename T>
   T Convert(const FieldDescriptor& field_descriptor) const {
-    const impl::AnyField& field = fields_.at(&field_descriptor);
-
-    return std::visit(
-        [](auto&& field) {
-          using U = std::decay_t<decltype(field)>;
-
-          if constexpr (impl::is_dynamic<U>::value) {
-            throw std::bad_variant_access();
-            return T{};
-          } else {
-            return static_cast<T>(field);
-          }
-        },
-        field);
+    return impl::LoadConvertValue<T>(FieldData(AtField(field_descriptor)), field_descriptor.type());
   }
 
   template <typename T>
   T Convert(std::string_view field_name) const {
-    return Convert<T>(*descriptor_[field_name]);
+    return Convert<T>(AtField(field_name));
   }
 
   template <typename T>
   std::optional<T> ConvertIf(const FieldDescriptor& field_descriptor) const {
-    const auto& field_it = fields_.find(&field_descriptor);
-    if (field_it == fields_.end()) return std::nullopt;
-
-    return std::visit(
-        [](auto&& field) {
-          using U = std::decay_t<decltype(field)>;
-
-          if constexpr (impl::is_dynamic<U>::value) {
-            throw std::bad_variant_access();
-            return std::optional<T>{};
-          } else {
-            return std::optional<T>{static_cast<T>(field)};
-          }
-        },
-        field_it->second);
+    if (!HasField(field_descriptor)) return std::nullopt;
+    return Convert<T>(field_descriptor);
   }
 
   template <typename T>
   std::optional<T> ConvertIf(std::string_view field_name) const {
-    const FieldDescriptor *field = descriptor_[field_name];
+    const FieldDescriptor *field = (*descriptor_)[field_name];
     if (!field) return std::nullopt;
     return ConvertIf<T>(*field);
   }
 
-  const TypeDescriptor& descriptor() const { return descriptor_; }
+  const TypeDescriptor& descriptor() const { return *descriptor_; }
 
  private:
-  void UnpackBitfield(const uint8_t *data) {
-    for (const std::unique_ptr<const FieldDescriptor>& field : descriptor_.struct_fields()) {
-      const TypeDescriptor& field_type = field->type();
-      impl::AnyField& any_field = fields_.at(field.get());
-      const int bit_offset = field->bit_offset();
-      const int bit_size = field->bit_size();
-
-      switch (descriptor_.prim_type()) {
-        case TypeDescriptor::PrimType::kUint8: {
-          const uint8_t raw_data = UnpackBe<uint8_t>(data);
-          switch (field_type.prim_type()) {
-            case TypeDescriptor::PrimType::kUint8:
-              std::get<uint8_t>(any_field) =
-                  dynamic::UnpackBitfield<uint8_t>(raw_data, bit_offset, bit_size);
-              break;
-            default:
-              throw std::runtime_error("Incorrect bitfield field prim_type.");
-          }
-          break;
-        }
-        case TypeDescriptor::PrimType::kUint16: {
-          const uint16_t raw_data = UnpackBe<uint16_t>(data);
-          switch (field_type.prim_type()) {
-            case TypeDescriptor::PrimType::kUint8:
-              std::get<uint8_t>(any_field) =
-                  dynamic::UnpackBitfield<uint8_t>(raw_data, bit_offset, bit_size);
-              break;
-            case TypeDescriptor::PrimType::kUint16:
-              std::get<uint16_t>(any_field) =
-                  dynamic::UnpackBitfield<uint16_t>(raw_data, bit_offset, bit_size);
-              break;
-            default:
-              throw std::runtime_error("Incorrect bitfield field prim_type.");
-          }
-          break;
-        }
-        case TypeDescriptor::PrimType::kUint32: {
-          const uint32_t raw_data = UnpackBe<uint32_t>(data);
-          switch (field_type.prim_type()) {
-            case TypeDescriptor::PrimType::kUint8:
-              std::get<uint8_t>(any_field) =
-                  dynamic::UnpackBitfield<uint8_t>(raw_data, bit_offset, bit_size);
-              break;
-            case TypeDescriptor::PrimType::kUint16:
-              std::get<uint16_t>(any_field) =
-                  dynamic::UnpackBitfield<uint16_t>(raw_data, bit_offset, bit_size);
-              break;
-            case TypeDescriptor::PrimType::kUint32:
-              std::get<uint32_t>(any_field) =
-                  dynamic::UnpackBitfield<uint32_t>(raw_data, bit_offset, bit_size);
-              break;
-            default:
-              throw std::runtime_error("Incorrect bitfield field prim_type.");
-          }
-          break;
-        }
-        case TypeDescriptor::PrimType::kUint64: {
-          const uint64_t raw_data = UnpackBe<uint64_t>(data);
-          switch (field_type.prim_type()) {
-            case TypeDescriptor::PrimType::kUint8:
-              std::get<uint8_t>(any_field) =
-                  dynamic::UnpackBitfield<uint8_t>(raw_data, bit_offset, bit_size);
-              break;
-            case TypeDescriptor::PrimType::kUint16:
-              std::get<uint16_t>(any_field) =
-                  dynamic::UnpackBitfield<uint16_t>(raw_data, bit_offset, bit_size);
-              break;
-            case TypeDescriptor::PrimType::kUint32:
-              std::get<uint32_t>(any_field) =
-                  dynamic::UnpackBitfield<uint32_t>(raw_data, bit_offset, bit_size);
-              break;
-            case TypeDescriptor::PrimType::kUint64:
-              std::get<uint64_t>(any_field) =
-                  dynamic::UnpackBitfield<uint64_t>(raw_data, bit_offset, bit_size);
-              break;
-            default:
-              throw std::runtime_error("Incorrect bitfield field prim_type.");
-          }
-          break;
-        }
-        default:
-          throw std::runtime_error("Incorrect bitfield prim_type.");
-      }
-    }
+  friend class impl::Handles;
+
+  // Handle aliasing a value inside another DynamicStruct or DynamicArray.
+  DynamicStruct(const TypeDescriptor& descriptor, uint8_t *data,
+                std::pmr::memory_resource *resource)
+      : descriptor_{&descriptor}, values_{data, resource} {}
+
+  void Assign(const TypeDescriptor& descriptor, const uint8_t *data);
+
+  template <typename T>
+  T& GetHandle(size_t i);
+
+  void ResetHandles();
+
+  // Whether a field belongs to this struct's type.
+  bool HasField(const FieldDescriptor& field_descriptor) const {
+    const size_t ordinal = field_descriptor.ordinal();
+    const TypeDescriptor::FieldList& fields = descriptor_->struct_fields();
+    return ordinal < fields.size() && fields[ordinal] == &field_descriptor;
+  }
+
+  const FieldDescriptor& AtField(const FieldDescriptor& field_descriptor) const {
+    if (!HasField(field_descriptor)) throw std::out_of_range("Field not in struct.");
+    return field_descriptor;
+  }
+
+  const FieldDescriptor& AtField(std::string_view field_name) const {
+    const FieldDescriptor *field = (*descriptor_)[field_name];
+    if (!field) throw std::out_of_range("No field \"" + std::string(field_name) + "\".");
+    return *field;
+  }
+
+  uint8_t *FieldData(const FieldDescriptor& field_descriptor) const {
+    return values_.data() + field_descriptor.value_offset();
   }
 
-  std::unordered_map<const FieldDescriptor *, impl::AnyField> fields_;
-  const TypeDescriptor& descriptor_;
+  const TypeDescriptor *descriptor_;
+  impl::ValueBuffer values_;
+  std::atomic<impl::Handles *> handles_{nullptr};
 };
 
+// An array value with the same storage model as DynamicStruct.
 class DynamicArray {
  public:
-  DynamicArray(const TypeDescriptor& descriptor)
-      : descriptor_{descriptor}, elems_(descriptor.array_size()) {
-    for (size_t i = 0; i < elems_.size(); ++i) {
-      elems_[i] = impl::MakeAnyField(descriptor.array_elem_type());
-    }
-  }
+  DynamicArray(const TypeDescriptor& descriptor,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : descriptor_{&descriptor}, values_{descriptor, resource} {}
 
-  void Unpack(const uint8_t *data) {
-    const TypeDescriptor& elem_type = descriptor_.array_elem_type();
+  DynamicArray(const DynamicArray& other,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : descriptor_{other.descriptor_},
+        values_{impl::ValueBuffer::Copy(*descriptor_, other.values_.data(), resource)} {}
 
-    for (impl::AnyField& any_field : elems_) {
-      switch (elem_type.type()) {
-        case TypeDescriptor::Type::kPrimitive:
-        case TypeDescriptor::Type::kEnum:
-          impl::UnpackToAnyField(any_field, data, elem_type.prim_type());
-          break;
-        case TypeDescriptor::Type::kArray:
-          std::get<impl::Box<DynamicArray>>(any_field)->Unpack(data);
-          break;
-        case TypeDescriptor::Type::kStruct:
-        case TypeDescriptor::Type::kBitfield:
-          std::get<impl::Box<DynamicStruct>>(any_field)->Unpack(data);
-          break;
-      }
+  DynamicArray(DynamicArray&& other) noexcept
+      : descriptor_{other.descriptor_},
+        values_{std::move(other.values_)},
+        handles_{values_.owned() ? other.handles_.exchange(nullptr) : nullptr} {}
 
-      data += elem_type.packed_size();
+  ~DynamicArray();
+
+  DynamicArray& operator=(const DynamicArray& other) {
+    if (this == &other) return *this;
+    Assign(*other.descriptor_, other.values_.data());
+    return *this;
+  }
+
+  DynamicArray& operator=(DynamicArray&& other) {
+    if (this == &other) return *this;
+    if (other.values_.owned() && (values_.owned() || values_.empty())) {
+      ResetHandles();
+      descriptor_ = other.descriptor_;
+      values_ = std::move(other.values_);
+      handles_ = other.handles_.exchange(nullptr);
+      return *this;
     }
+    return *this = static_cast<const DynamicArray&>(other);
   }
 
+  void Unpack(const uint8_t *data);
+
+  // Writes descriptor().packed_size() bytes.
+  void Pack(uint8_t *data) const;
+
   template <typename T>
   T& Get(size_t i) {
-    return *std::get<impl::Box<T>>(elems_[i]).get();
+    const TypeDescriptor& elem = descriptor_->array_elem_type();
+    if constexpr (impl::is_dynamic_v<T>) {
+      if (!impl::IsAggregate(elem)) throw std::bad_variant_access();
+      return GetHandle<T>(i);
+    } else {
+      return impl::ValueAt<T>(values_.data() + i * elem.value_size(), elem);
+    }
   }
 
   template <typename T>
@@ -410,56 +682,208 @@ class DynamicArray {
 
   template <typename T>
   T Convert(size_t i) const {
-    const impl::AnyField& field = elems_[i];
+    const TypeDescriptor& elem = descriptor_->array_elem_type();
+    return impl::LoadConvertValue<T>(values_.data() + i * elem.value_size(), elem);
+  }
 
-    return std::visit(
-        [](auto&& field) {
-          using U = std::decay_t<decltype(field)>;
+  // Elements of an array of primitives (or enums) as a contiguous, aligned run of T.  T must match
+  // the element type exactly, otherwise throws std::bad_variant_access (as Get).
+  template <typename T>
+  Span<T> AsSpan() {
+    const TypeDescriptor& elem = descriptor_->array_elem_type();
+    if (impl::IsAggregate(elem) || impl::PrimTypeOf<T>() != elem.prim_type()) {
+      throw std::bad_variant_access();
+    }
+    return Span<T>(reinterpret_cast<T *>(values_.data()), size());
+  }
 
-          if constexpr (impl::is_dynamic<U>::value) {
-            throw std::bad_variant_access();
-            return T{};
-          } else {
-            return static_cast<T>(field);
-          }
-        },
-        field);
+  template <typename T>
+  Span<const T> AsSpan() const {
+    return const_cast<DynamicArray *>(this)->AsSpan<T>();
   }
 
-  size_t size() const { return elems_.size(); };
-  const TypeDescriptor& descriptor() const { return descriptor_; }
+  size_t size() const { return descriptor_->array_size(); };
+  const TypeDescriptor& descriptor() const { return *descriptor_; }
 
  private:
-  const TypeDescriptor& descriptor_;
-  std::vector<impl::AnyField> elems_;
+  friend class impl::Handles;
+
+  DynamicArray(const TypeDescriptor& descriptor, uint8_t *data,
+               std::pmr::memory_resource *resource)
+      : descriptor_{&descriptor}, values_{data, resource} {}
+
+  void Assign(const TypeDescriptor& descriptor, const uint8_t *data);
+
+  template <typename T>
+  T& GetHandle(size_t i);
+
+  void ResetHandles();
+
+  const TypeDescriptor *descriptor_;
+  impl::ValueBuffer values_;
+  std::atomic<impl::Handles *> handles_{nullptr};
 };
 
-inline void DynamicStruct::Unpack(const uint8_t *data) {
-  if (descriptor_.type() == TypeDescriptor::Type::kBitfield) {
-    UnpackBitfield(data);
-    return;
+namespace impl {
+
+template <typename T>
+T& ValueAt(uint8_t *data, const TypeDescriptor& type) {
+  if (IsAggregate(type) || PrimTypeOf<T>() != type.prim_type()) throw std::bad_variant_access();
+  return *reinterpret_cast<T *>(data);
+}
+
+// The handles for the nested structs and arrays directly inside one value: entry i is for field
+// ordinal i of a struct, or element i of an array.  All of them, followed by the entries, are one
+// allocation from the value's resource.
+class Handles {
+ public:
+  Handles(const Handles&) = delete;
+  Handles& operator=(const Handles&) = delete;
+
+  // Returns *slot, first installing new handles for the value at data if it is empty.  Racing
+  // callers agree on one set of handles, but each allocates from resource, which must be
+  // thread-safe for that (see DynamicStruct).
+  static Handles& Get(std::atomic<Handles *>& slot, const TypeDescriptor& type, uint8_t *data,
+                      std::pmr::memory_resource *resource) {
+    Handles *handles = slot.load(std::memory_order_acquire);
+    if (handles) return *handles;
+
+    handles = Create(type, data, resource);
+    Handles *expected = nullptr;
+    if (!slot.compare_exchange_strong(expected, handles, std::memory_order_acq_rel)) {
+      // Another reader installed its handles first.
+      Destroy(handles);
+      return *expected;
+    }
+    return *handles;
+  }
+
+  static void Destroy(Handles *handles) {
+    if (!handles) return;
+
+    std::pmr::memory_resource *resource = handles->resource_;
+    const size_t size = handles->size_;
+    for (size_t i = 0; i < size; ++i) handles->entries()[i].~Entry();
+    handles->~Handles();
+    resource->deallocate(handles, AllocSize(size), alignof(Handles));
+  }
+
+  template <typename T>
+  T& At(size_t i) {
+    return std::get<T>(entries()[i]);
   }
 
-  for (const std::unique_ptr<const FieldDescriptor>& field : descriptor_.struct_fields()) {
-    const TypeDescriptor& field_type = field->type();
-    impl::AnyField& any_field = fields_.at(field.get());
-
-    switch (field_type.type()) {
-      case TypeDescriptor::Type::kPrimitive:
-      case TypeDescriptor::Type::kEnum:
-        impl::UnpackToAnyField(any_field, data, field_type.prim_type());
-        break;
-      case TypeDescriptor::Type::kArray:
-        std::get<impl::Box<DynamicArray>>(any_field)->Unpack(data);
-        break;
-      case TypeDescriptor::Type::kStruct:
-      case TypeDescriptor::Type::kBitfield:
-        std::get<impl::Box<DynamicStruct>>(any_field)->Unpack(data);
-        break;
+ private:
+  using Entry = std::variant<std::monostate, DynamicStruct, DynamicArray>;
+
+  Handles(std::pmr::memory_resource *resource, size_t size) : resource_{resource}, size_{size} {}
+
+  static size_t AllocSize(size_t size) { return sizeof(Handles) + size * sizeof(Entry); }
+
+  static Handles *Create(const TypeDescriptor& type, uint8_t *data,
+                         std::pmr::memory_resource *resource) {
+    static_assert(sizeof(Handles) % alignof(Entry) == 0 && alignof(Entry) <= alignof(Handles));
+
+    const size_t size = type.IsArray() ? type.array_size() : type.struct_fields().size();
+    void *memory = resource->allocate(AllocSize(size), alignof(Handles));
+    Handles *handles = new (memory) Handles(resource, size);
+
+    Entry *entries = handles->entries();
+    if (type.IsArray()) {
+      const TypeDescriptor& elem = type.array_elem_type();
+      for (size_t i = 0; i < size; ++i) {
+        new (&entries[i]) Entry(MakeHandle(elem, data + i * elem.value_size(), resource));
+      }
+    } else {
+      for (const FieldDescriptor *field : type.struct_fields()) {
+        new (&entries[field->ordinal()])
+            Entry(MakeHandle(field->type(), data + field->value_offset(), resource));
+      }
     }
+    return handles;
+  }
+
+  static Entry MakeHandle(const TypeDescriptor& type, uint8_t *data,
+                          std::pmr::memory_resource *resource) {
+    if (type.IsArray()) return DynamicArray(type, data, resource);
+    if (type.IsStruct() || type.IsBitfield()) return DynamicStruct(type, data, resource);
+    return std::monostate();
+  }
+
+  Entry *entries() { return reinterpret_cast<Entry *>(this + 1); }
+
+  std::pmr::memory_resource *resource_;
+  size_t size_;
+};
+
+}  // namespace impl
 
-    data += field_type.packed_size();
+inline DynamicStruct::~DynamicStruct() { impl::Handles::Destroy(handles_.load()); }
+
+inline void DynamicStruct::Assign(const TypeDescriptor& descriptor, const uint8_t *data) {
+  if (data && &descriptor == descriptor_ && !values_.empty()) {
+    memmove(values_.data(), data, descriptor.value_size());
+    return;
   }
+
+  if (!values_.owned() && !values_.empty()) {
+    throw std::runtime_error(data ? "Cannot assign a different type to a field."
+                                  : "Cannot assign a moved from value to a field.");
+  }
+  // data may point into the current buffer.
+  impl::ValueBuffer values = impl::ValueBuffer::Copy(descriptor, data, values_.resource());
+  ResetHandles();
+  values_ = std::move(values);
+  descriptor_ = &descriptor;
+}
+
+template <typename T>
+T& DynamicStruct::GetHandle(size_t i) {
+  return impl::Handles::Get(handles_, *descriptor_, values_.data(), values_.resource()).At<T>(i);
+}
+
+inline void DynamicStruct::ResetHandles() { impl::Handles::Destroy(handles_.exchange(nullptr)); }
+
+inline DynamicArray::~DynamicArray() { impl::Handles::Destroy(handles_.load()); }
+
+inline void DynamicArray::Assign(const TypeDescriptor& descriptor, const uint8_t *data) {
+  if (data && &descriptor == descriptor_ && !values_.empty()) {
+    memmove(values_.data(), data, descriptor.value_size());
+    return;
+  }
+
+  if (!values_.owned() && !values_.empty()) {
+    throw std::runtime_error(data ? "Cannot assign a different type to a field."
+                                  : "Cannot assign a moved from value to a field.");
+  }
+  // data may point into the current buffer.
+  impl::ValueBuffer values = impl::ValueBuffer::Copy(descriptor, data, values_.resource());
+  ResetHandles();
+  values_ = std::move(values);
+  descriptor_ = &descriptor;
+}
+
+template <typename T>
+T& DynamicArray::GetHandle(size_t i) {
+  return impl::Handles::Get(handles_, *descriptor_, values_.data(), values_.resource()).At<T>(i);
+}
+
+inline void DynamicArray::ResetHandles() { impl::Handles::Destroy(handles_.exchange(nullptr)); }
+
+inline void DynamicStruct::Unpack(const uint8_t *data) {
+  impl::ExecuteUnpackPlan(descriptor_->unpack_plan(), data, values_.data());
+}
+
+inline void DynamicArray::Unpack(const uint8_t *data) {
+  impl::ExecuteUnpackPlan(descriptor_->unpack_plan(), data, values_.data());
+}
+
+inline void DynamicStruct::Pack(uint8_t *data) const {
+  impl::ExecutePackPlan(descriptor_->unpack_plan(), values_.data(), data);
+}
+
+inline void DynamicArray::Pack(uint8_t *data) const {
+  impl::ExecutePackPlan(descriptor_->unpack_plan(), values_.data(), data);
 }
 
 enum class UnpackStatus {
@@ -468,29 +892,119 @@ enum class UnpackStatus {
   kInvalidUid,
 };
 
-static std::pair<std::optional<DynamicStruct>, UnpackStatus> UnpackMessage(
-    const uint8_t *data, size_t len, const DescriptorBuilder& types) {
-  if (len < 6) return std::make_pair(std::nullopt, UnpackStatus::kInvalidLen);
+namespace impl {
 
-  DynamicStruct ss_header(*types["SsHeader"]);
-  ss_header.Unpack(data);
+// Validates a packed message's SsHeader against len and types, returning its type on success.
+template <typename Types>
+std::pair<const TypeDescriptor *, UnpackStatus> CheckMessage(const uint8_t *data, size_t len,
+                                                              const Types& types) {
+  if (len < 6) return {nullptr, UnpackStatus::kInvalidLen};
 
-  const uint16_t msg_len = ss_header.Get<uint16_t>("len");
-  if (msg_len != len) return std::make_pair(std::nullopt, UnpackStatus::kInvalidLen);
+  // SsHeader: uid, then len.
+  const uint16_t msg_len = UnpackBe<uint16_t>(data + 4);
+  if (msg_len != len) return {nullptr, UnpackStatus::kInvalidLen};
 
-  const uint32_t msg_uid = ss_header.Get<uint32_t>("uid");
+  const uint32_t msg_uid = UnpackBe<uint32_t>(data);
 
   const TypeDescriptor *msg_type = types.LookupMsgFromUid(msg_uid);
-  if (!msg_type) return std::make_pair(std::nullopt, UnpackStatus::kInvalidUid);
+  if (!msg_type) return {nullptr, UnpackStatus::kInvalidUid};
+
+  if (msg_len != msg_type->packed_size()) return {nullptr, UnpackStatus::kInvalidLen};
+
+  return {msg_type, UnpackStatus::kSuccess};
+}
+
+}  // namespace impl
 
-  if (msg_len != msg_type->packed_size()) {
-    return std::make_pair(std::nullopt, UnpackStatus::kInvalidLen);
+// Types is a DescriptorBuilder or a DescriptorRegistry::Snapshot.  The message's one allocation
+// comes from resource, e.g. a std::pmr::monotonic_buffer_resource shared by a batch of messages
+// (read from one thread at a time, see DynamicStruct).
+template <typename Types>
+std::pair<std::optional<DynamicStruct>, UnpackStatus> UnpackMessage(
+    const uint8_t *data, size_t len, const Types& types,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+  const auto [msg_type, status] = impl::CheckMessage(data, len, types);
+  if (!msg_type) return std::make_pair(std::nullopt, status);
+
+  std::pair<std::optional<DynamicStruct>, UnpackStatus> ret(std::nullopt, UnpackStatus::kSuccess);
+  ret.first.emplace(*msg_type, resource);
+  ret.first->Unpack(data);
+  return ret;
+}
+
+// Packs a message into data, filling in its SsHeader uid and len as the generated Message::Pack
+// does (msg itself is left unchanged).  Returns the number of bytes written, or 0 if len is too
+// short.  Throws std::runtime_error if msg is not a message.
+inline size_t PackMessage(const DynamicStruct& msg, uint8_t *data, size_t len) {
+  const TypeDescriptor& msg_type = msg.descriptor();
+  if (!msg_type.IsStruct() || !msg_type.struct_is_message()) {
+    throw std::runtime_error("PackMessage requires a message type.");
   }
 
-  DynamicStruct msg(*msg_type);
-  msg.Unpack(data);
-  return std::make_pair(msg, UnpackStatus::kSuccess);
+  const size_t msg_len = msg_type.packed_size();
+  if (len < msg_len) return 0;
+
+  msg.Pack(data);
+
+  // SsHeader: uid, then len.
+  PackBe<uint32_t>(msg_type.uid(), data);
+  PackBe<uint16_t>(msg_len, data + 4);
+
+  return msg_len;
 }
 
+// Decodes a stream of messages into one cached DynamicStruct per message type, which is built the
+// first time its type is seen and re-decoded in place after that.  Once every type in the stream
+// has been seen, decoding does no allocation.
+//
+// Types (a DescriptorBuilder or a DescriptorRegistry::Snapshot) is either borrowed, and must then
+// outlive the decoder, or shared with it:
+//
+//   MessageDecoder decoder(registry.ReadShared());
+//
+// A shared snapshot stays valid for the decoder while DescriptorRegistry::Publish goes ahead; build
+// a new decoder to pick up the published specs.
+template <typename Types>
+class MessageDecoder {
+ public:
+  explicit MessageDecoder(const Types& types,
+                          std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : types_{&types}, resource_{resource}, messages_{resource} {}
+
+  // A temporary would be destroyed before the first Unpack.
+  explicit MessageDecoder(const Types&& types, std::pmr::memory_resource *resource =
+                                                   std::pmr::get_default_resource()) = delete;
+
+  // Keeps types alive for the lifetime of the decoder.
+  explicit MessageDecoder(std::shared_ptr<const Types> types,
+                          std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : owner_{std::move(types)}, types_{owner_.get()}, resource_{resource}, messages_{resource} {
+    if (!types_) throw std::runtime_error("MessageDecoder requires types.");
+  }
+
+  MessageDecoder(const MessageDecoder&) = delete;
+  MessageDecoder& operator=(const MessageDecoder&) = delete;
+
+  // On success the message is valid until the next Unpack of a message of the same type, or the
+  // decoder is destroyed.
+  std::pair<DynamicStruct *, UnpackStatus> Unpack(const uint8_t *data, size_t len) {
+    const auto [msg_type, status] = impl::CheckMessage(data, len, *types_);
+    if (!msg_type) return {nullptr, status};
+
+    DynamicStruct& msg = messages_.try_emplace(msg_type, *msg_type, resource_).first->second;
+    msg.Unpack(data);
+    return {&msg, UnpackStatus::kSuccess};
+  }
+
+  // Number of cached messages, one per type seen.
+  size_t size() const { return messages_.size(); }
+
+ private:
+  std::shared_ptr<const Types> owner_;
+  const Types *types_;
+  std::pmr::memory_resource *resource_;
+  std::pmr::unordered_map<const TypeDescriptor *, DynamicStruct> messages_;
+};
+
 }  // namespace dynamic
 }  // namespace ss
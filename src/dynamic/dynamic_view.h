@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/field_accessor.h"
+#include "src/dynamic/packing.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+class DynamicArrayView;
+class DynamicView;
+
+namespace impl {
+
+template <typename T>
+inline constexpr bool is_view_v =
+    std::is_same_v<T, DynamicView> || std::is_same_v<T, DynamicArrayView>;
+
+// Element or field at data of the given type.  Primitives (and enums) are decoded, aggregates are
+// returned as views.  Same type checking as std::get on DynamicStruct's storage.
+template <typename T>
+T ViewValue(const uint8_t *data, const TypeDescriptor& type);
+
+template <typename T>
+T ConvertValue(const uint8_t *data, const TypeDescriptor& type) {
+  if (type.IsArray() || type.IsStruct() || type.IsBitfield()) throw std::bad_variant_access();
+  return UnpackConvert<T>(type.prim_type(), data);
+}
+
+}  // namespace impl
+
+// Read-only, non-owning view of a packed struct or bitfield.  Mirrors DynamicStruct's accessors,
+// but decodes only the fields that are read, and nested structs and arrays are returned by value
+// as sub-views.  Nothing is allocated.  data must hold descriptor.packed_size() bytes and outlive
+// the view.
+class DynamicView {
+ public:
+  DynamicView(const uint8_t *data, const TypeDescriptor& descriptor)
+      : data_{data}, descriptor_{&descriptor} {
+    if (!descriptor.IsStruct() && !descriptor.IsBitfield()) {
+      throw std::runtime_error("DynamicView requires a struct or bitfield type.");
+    }
+  }
+
+  // T is a primitive type (which must match the field exactly), DynamicView or DynamicArrayView.
+  template <typename T>
+  T Get(const FieldDescriptor& field_descriptor) const {
+    if (!HasField(field_descriptor)) throw std::out_of_range("Field not in struct.");
+    return GetField<T>(field_descriptor);
+  }
+
+  template <typename T>
+  T Get(std::string_view field_name) const {
+    return Get<T>(AtField(field_name));
+  }
+
+  // std::nullopt if the field does not belong to this struct.
+  template <typename T>
+  std::optional<T> GetIf(const FieldDescriptor& field_descriptor) const {
+    if (!HasField(field_descriptor)) return std::nullopt;
+    return GetField<T>(field_descriptor);
+  }
+
+  template <typename T>
+  std::optional<T> GetIf(std::string_view field_name) const {
+    const FieldDescriptor *field = (*descriptor_)[field_name];
+    if (!field) return std::nullopt;
+    return GetIf<T>(*field);
+  }
+
+  template <typename T>
+  T Convert(const FieldDescriptor& field_descriptor) const {
+    if (!HasField(field_descriptor)) throw std::out_of_range("Field not in struct.");
+    return ConvertField<T>(field_descriptor);
+  }
+
+  template <typename T>
+  T Convert(std::string_view field_name) const {
+    return Convert<T>(AtField(field_name));
+  }
+
+  template <typename T>
+  std::optional<T> ConvertIf(const FieldDescriptor& field_descriptor) const {
+    if (!HasField(field_descriptor)) return std::nullopt;
+    return ConvertField<T>(field_descriptor);
+  }
+
+  template <typename T>
+  std::optional<T> ConvertIf(std::string_view field_name) const {
+    const FieldDescriptor *field = (*descriptor_)[field_name];
+    if (!field) return std::nullopt;
+    return ConvertIf<T>(*field);
+  }
+
+  const uint8_t *data() const { return data_; }
+  const TypeDescriptor& descriptor() const { return *descriptor_; }
+
+ private:
+  bool HasField(const FieldDescriptor& field_descriptor) const {
+    const size_t ordinal = field_descriptor.ordinal();
+    const TypeDescriptor::FieldList& fields = descriptor_->struct_fields();
+    return ordinal < fields.size() && fields[ordinal] == &field_descriptor;
+  }
+
+  const FieldDescriptor& AtField(std::string_view field_name) const {
+    const FieldDescriptor *field = (*descriptor_)[field_name];
+    if (!field) throw std::out_of_range("No field \"" + std::string(field_name) + "\".");
+    return *field;
+  }
+
+  uint64_t BitfieldValue(const FieldDescriptor& field_descriptor) const {
+    const uint64_t raw = impl::UnpackConvert<uint64_t>(descriptor_->prim_type(), data_);
+    const int bit_size = field_descriptor.bit_size();
+    const uint64_t mask = bit_size == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_size) - 1;
+    return (raw >> field_descriptor.bit_offset()) & mask;
+  }
+
+  template <typename T>
+  T GetField(const FieldDescriptor& field_descriptor) const {
+    if (!descriptor_->IsBitfield()) {
+      return impl::ViewValue<T>(data_ + field_descriptor.offset(), field_descriptor.type());
+    }
+
+    if constexpr (impl::is_view_v<T>) {
+      throw std::bad_variant_access();
+    } else {
+      if (impl::PrimTypeOf<T>() != field_descriptor.type().prim_type()) {
+        throw std::bad_variant_access();
+      }
+      return static_cast<T>(BitfieldValue(field_descriptor));
+    }
+  }
+
+  template <typename T>
+  T ConvertField(const FieldDescriptor& field_descriptor) const {
+    if (descriptor_->IsBitfield()) return static_cast<T>(BitfieldValue(field_descriptor));
+    return impl::ConvertValue<T>(data_ + field_descriptor.offset(), field_descriptor.type());
+  }
+
+  const uint8_t *data_;
+  const TypeDescriptor *descriptor_;
+};
+
+// Read-only, non-owning view of a packed array.  Mirrors DynamicArray.
+class DynamicArrayView {
+ public:
+  DynamicArrayView(const uint8_t *data, const TypeDescriptor& descriptor)
+      : data_{data}, descriptor_{&descriptor} {
+    if (!descriptor.IsArray()) throw std::runtime_error("DynamicArrayView requires an array type.");
+  }
+
+  template <typename T>
+  T Get(size_t i) const {
+    const TypeDescriptor& elem = descriptor_->array_elem_type();
+    return impl::ViewValue<T>(data_ + i * elem.packed_size(), elem);
+  }
+
+  template <typename T>
+  T Convert(size_t i) const {
+    const TypeDescriptor& elem = descriptor_->array_elem_type();
+    return impl::ConvertValue<T>(data_ + i * elem.packed_size(), elem);
+  }
+
+  size_t size() const { return descriptor_->array_size(); }
+  const uint8_t *data() const { return data_; }
+  const TypeDescriptor& descriptor() const { return *descriptor_; }
+
+ private:
+  const uint8_t *data_;
+  const TypeDescriptor *descriptor_;
+};
+
+namespace impl {
+
+template <typename T>
+T ViewValue(const uint8_t *data, const TypeDescriptor& type) {
+  if constexpr (std::is_same_v<T, DynamicView>) {
+    if (!type.IsStruct() && !type.IsBitfield()) throw std::bad_variant_access();
+    return DynamicView(data, type);
+  } else if constexpr (std::is_same_v<T, DynamicArrayView>) {
+    if (!type.IsArray()) throw std::bad_variant_access();
+    return DynamicArrayView(data, type);
+  } else {
+    if (type.IsArray() || type.IsStruct() || type.IsBitfield() ||
+        PrimTypeOf<T>() != type.prim_type()) {
+      throw std::bad_variant_access();
+    }
+    return UnpackBe<T>(data);
+  }
+}
+
+}  // namespace impl
+
+// Validates the header like UnpackMessage, but returns a view instead of decoding.
+template <typename Types>
+std::pair<std::optional<DynamicView>, UnpackStatus> ViewMessage(const uint8_t *data, size_t len,
+                                                                const Types& types) {
+  const auto [msg_type, status] = impl::CheckMessage(data, len, types);
+  if (!msg_type) return std::make_pair(std::nullopt, status);
+
+  return std::make_pair(DynamicView(data, *msg_type), UnpackStatus::kSuccess);
+}
+
+}  // namespace dynamic
+}  // namespace ss
@@ -0,0 +1,94 @@
+#include "src/dynamic/field_accessor.h"
+
+#include <algorithm>
+#include <string>
+
+namespace ss {
+namespace dynamic {
+
+namespace {
+
+[[noreturn]] void ThrowPathError(std::string_view path, const std::string& reason) {
+  throw std::runtime_error("Invalid field path \"" + std::string(path) + "\": " + reason);
+}
+
+}  // namespace
+
+FieldAccessor FieldAccessor::Compile(const TypeDescriptor& root, std::string_view path) {
+  FieldAccessor accessor;
+  const TypeDescriptor *type = &root;
+  uint32_t offset = 0;
+
+  size_t pos = 0;
+  while (pos < path.size()) {
+    if (accessor.is_bitfield_field_) ThrowPathError(path, "bitfield field must be last.");
+
+    if (path[pos] == '[') {
+      if (!type->IsArray()) {
+        ThrowPathError(path, "\"" + std::string(type->name()) + "\" is not an array.");
+      }
+
+      const size_t close = path.find(']', pos);
+      if (close == std::string_view::npos || close == pos + 1) {
+        ThrowPathError(path, "malformed index.");
+      }
+
+      uint64_t index = 0;
+      for (size_t i = pos + 1; i < close; ++i) {
+        if (path[i] < '0' || path[i] > '9') ThrowPathError(path, "malformed index.");
+        index = index * 10 + (path[i] - '0');
+        if (index >= static_cast<uint64_t>(type->array_size())) {
+          ThrowPathError(path, "index out of range.");
+        }
+      }
+
+      type = &type->array_elem_type();
+      offset += index * type->packed_size();
+      pos = close + 1;
+      continue;
+    }
+
+    if (path[pos] == '.') {
+      if (pos == 0) ThrowPathError(path, "leading '.'.");
+      ++pos;
+    } else if (pos != 0) {
+      ThrowPathError(path, "expected '.' or '['.");
+    }
+
+    const size_t end = std::min(path.find_first_of(".[", pos), path.size());
+    const std::string_view name = path.substr(pos, end - pos);
+    if (name.empty()) ThrowPathError(path, "empty field name.");
+
+    if (!type->IsStruct() && !type->IsBitfield()) {
+      ThrowPathError(path, "\"" + std::string(type->name()) + "\" has no fields.");
+    }
+
+    const FieldDescriptor *field = (*type)[name];
+    if (!field) ThrowPathError(path, "no field \"" + std::string(name) + "\".");
+
+    if (type->IsBitfield()) {
+      accessor.is_bitfield_field_ = true;
+      accessor.container_type_ = type->prim_type();
+      accessor.shift_ = field->bit_offset();
+      accessor.mask_ =
+          field->bit_size() == 64 ? ~uint64_t{0} : (uint64_t{1} << field->bit_size()) - 1;
+    } else {
+      offset += field->offset();
+    }
+
+    type = &field->type();
+    pos = end;
+  }
+
+  if (!type->IsPrimitive() && !type->IsEnum() && !type->IsBitfield()) {
+    ThrowPathError(path, "\"" + std::string(type->name()) + "\" is not a primitive.");
+  }
+
+  accessor.type_ = type;
+  accessor.prim_type_ = type->prim_type();
+  accessor.offset_ = offset;
+  return accessor;
+}
+
+}  // namespace dynamic
+}  // namespace ss
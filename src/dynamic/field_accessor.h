@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "src/dynamic/packing.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace impl {
+
+// Unpacks one big endian primitive and static_casts it to T.
+template <typename T>
+static inline T UnpackConvert(TypeDescriptor::PrimType prim_type, const uint8_t *data) {
+  using PrimType = TypeDescriptor::PrimType;
+
+  switch (prim_type) {
+    case PrimType::kUint8:
+      return static_cast<T>(UnpackBe<uint8_t>(data));
+    case PrimType::kUint16:
+      return static_cast<T>(UnpackBe<uint16_t>(data));
+    case PrimType::kUint32:
+      return static_cast<T>(UnpackBe<uint32_t>(data));
+    case PrimType::kUint64:
+      return static_cast<T>(UnpackBe<uint64_t>(data));
+    case PrimType::kInt8:
+      return static_cast<T>(UnpackBe<int8_t>(data));
+    case PrimType::kInt16:
+      return static_cast<T>(UnpackBe<int16_t>(data));
+    case PrimType::kInt32:
+      return static_cast<T>(UnpackBe<int32_t>(data));
+    case PrimType::kInt64:
+      return static_cast<T>(UnpackBe<int64_t>(data));
+    case PrimType::kBool:
+      return static_cast<T>(UnpackBe<bool>(data));
+    case PrimType::kFloat:
+      return static_cast<T>(UnpackBe<float>(data));
+    case PrimType::kDouble:
+      return static_cast<T>(UnpackBe<double>(data));
+  }
+
+  throw std::runtime_error("Invalid prim_type.");
+}
+
+}  // namespace impl
+
+// A single primitive, enum or bitfield field located by a path such as "array_2d[1][2].field1",
+// resolved once against a TypeDescriptor.  Reading it from a packed buffer of that type is a
+// constant offset load (plus shift and mask for bitfield fields) with no intermediate
+// DynamicStruct.
+class FieldAccessor {
+ public:
+  using PrimType = TypeDescriptor::PrimType;
+
+  // Path grammar: field ('[' index ']')* ('.' field ('[' index ']')*)*, where a leading index is
+  // allowed when root is an array.  Throws std::runtime_error if the path does not resolve to a
+  // primitive, enum, bitfield or bitfield field.
+  static FieldAccessor Compile(const TypeDescriptor& root, std::string_view path);
+
+  // Type of the value read: the primitive, enum or bitfield type, or the bitfield field's type.
+  const TypeDescriptor& type() const { return *type_; }
+  PrimType prim_type() const { return prim_type_; }
+
+  // Byte offset of the value (or the containing bitfield) from the start of the root.
+  uint32_t offset() const { return offset_; }
+
+  bool is_bitfield_field() const { return is_bitfield_field_; }
+  int bit_offset() const { return shift_; }
+  uint64_t bit_mask() const { return mask_; }
+  // prim_type of the containing bitfield, for bitfield fields.
+  PrimType container_type() const { return container_type_; }
+
+  // T must match prim_type() exactly, otherwise throws std::bad_variant_access (as
+  // DynamicStruct::Get).
+  template <typename T>
+  T Get(const uint8_t *data) const {
+    if (impl::PrimTypeOf<T>() != prim_type_) throw std::bad_variant_access();
+    return Convert<T>(data);
+  }
+
+  // static_cast of the value to T.
+  template <typename T>
+  T Convert(const uint8_t *data) const {
+    if (!is_bitfield_field_) return impl::UnpackConvert<T>(prim_type_, data + offset_);
+
+    const uint64_t raw = impl::UnpackConvert<uint64_t>(container_type_, data + offset_);
+    return static_cast<T>((raw >> shift_) & mask_);
+  }
+
+ private:
+  FieldAccessor() = default;
+
+  const TypeDescriptor *type_ = nullptr;
+  uint64_t mask_ = 0;
+  uint32_t offset_ = 0;
+  PrimType prim_type_ = PrimType::kUint8;
+  PrimType container_type_ = PrimType::kUint8;
+  uint8_t shift_ = 0;
+  bool is_bitfield_field_ = false;
+};
+
+}  // namespace dynamic
+}  // namespace ss
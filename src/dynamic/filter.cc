@@ -0,0 +1,415 @@
+#include "src/dynamic/filter.h"
+
+#include <cctype>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace ss {
+namespace dynamic {
+
+namespace {
+
+using Op = impl::FilterOp;
+
+// Every subexpression leaves one value on the stack (kAndJump and kOrJump pop the left side before
+// the right side runs), so only a comparison's two operands are ever on it at once.
+constexpr size_t kMaxDepth = 2;
+
+template <typename T>
+bool CompareValues(Op::Compare compare, T lhs, T rhs) {
+  switch (compare) {
+    case Op::Compare::kEq:
+      return lhs == rhs;
+    case Op::Compare::kNe:
+      return lhs != rhs;
+    case Op::Compare::kLt:
+      return lhs < rhs;
+    case Op::Compare::kLe:
+      return lhs <= rhs;
+    case Op::Compare::kGt:
+      return lhs > rhs;
+    case Op::Compare::kGe:
+      return lhs >= rhs;
+  }
+  return false;
+}
+
+}  // namespace
+
+namespace impl {
+
+// Recursive descent parser emitting Filter ops as it goes.  Fields and literals are held back until
+// both sides of a comparison are known, since the comparison decides what they are converted to.
+class FilterCompiler {
+ public:
+  FilterCompiler(const TypeDescriptor& type, std::string_view expr)
+      : filter_{type}, type_{type}, expr_{expr} {}
+
+  Filter Compile() {
+    ParseOr();
+    if (!Peek().empty()) Fail("unexpected \"" + std::string(Peek()) + "\".");
+    return std::move(filter_);
+  }
+
+ private:
+  // Value categories, which decide the comparison domain.
+  enum class Category {
+    kSigned,
+    kUnsigned,  // Known to be non-negative, and fits in an int64.
+    kUint64,
+    kFloat,
+  };
+
+  struct Operand {
+    enum class Kind {
+      kField,
+      kNumber,
+      kName,  // Not a field; may be a value of the enum it is compared with.
+      kExpr,  // Already emitted.
+    };
+
+    Kind kind;
+    std::string_view text;
+    std::optional<FieldAccessor> accessor;
+    std::string error;
+  };
+
+  [[noreturn]] void Fail(const std::string& reason) const {
+    throw std::runtime_error("Invalid filter \"" + std::string(expr_) + "\": " + reason);
+  }
+
+  static bool IsPathChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '[' ||
+           c == ']';
+  }
+
+  static bool IsNumberChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '+' || c == '-';
+  }
+
+  // The next token, without consuming it.  Empty at the end of the expression.
+  std::string_view Peek() {
+    while (pos_ < expr_.size() && std::isspace(static_cast<unsigned char>(expr_[pos_]))) ++pos_;
+    if (pos_ == expr_.size()) return {};
+
+    const std::string_view rest = expr_.substr(pos_);
+    for (std::string_view op : {"&&", "||", "==", "!=", "<=", ">="}) {
+      if (rest.substr(0, 2) == op) return rest.substr(0, 2);
+    }
+
+    const char c = rest[0];
+    size_t size = 1;
+    if (std::isdigit(static_cast<unsigned char>(c)) ||
+        ((c == '-' || c == '.') && rest.size() > 1 &&
+         std::isdigit(static_cast<unsigned char>(rest[1])))) {
+      // Signs inside a number only follow an exponent.
+      while (size < rest.size() && IsNumberChar(rest[size]) &&
+             ((rest[size] != '+' && rest[size] != '-') ||
+              rest[size - 1] == 'e' || rest[size - 1] == 'E')) {
+        ++size;
+      }
+    } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+      while (size < rest.size() && IsPathChar(rest[size])) ++size;
+    }
+    return rest.substr(0, size);
+  }
+
+  std::string_view Next() {
+    const std::string_view token = Peek();
+    pos_ += token.size();
+    return token;
+  }
+
+  bool Accept(std::string_view token) {
+    if (Peek() != token) return false;
+    pos_ += token.size();
+    return true;
+  }
+
+  size_t Emit(Op op) {
+    filter_.ops_.push_back(op);
+    return filter_.ops_.size() - 1;
+  }
+
+  // Short circuits: a && b is a, kAndJump past b, b.
+  void ParseOr() {
+    ParseAnd();
+    while (Accept("||")) {
+      const size_t jump = Emit(Op{Op::Kind::kOrJump});
+      ParseAnd();
+      filter_.ops_[jump].target = filter_.ops_.size();
+    }
+  }
+
+  void ParseAnd() {
+    ParseUnary();
+    while (Accept("&&")) {
+      const size_t jump = Emit(Op{Op::Kind::kAndJump});
+      ParseUnary();
+      filter_.ops_[jump].target = filter_.ops_.size();
+    }
+  }
+
+  void ParseUnary() {
+    if (Accept("!")) {
+      ParseUnary();
+      Emit(Op{Op::Kind::kNot});
+      return;
+    }
+    ParseComparison();
+  }
+
+  void ParseComparison() {
+    const Operand lhs = ParseOperand();
+
+    static constexpr std::pair<std::string_view, Op::Compare> kCompares[] = {
+        {"==", Op::Compare::kEq}, {"!=", Op::Compare::kNe}, {"<", Op::Compare::kLt},
+        {"<=", Op::Compare::kLe}, {">", Op::Compare::kGt},  {">=", Op::Compare::kGe},
+    };
+
+    const std::string_view token = Peek();
+    for (const auto& [text, compare] : kCompares) {
+      if (token != text) continue;
+      Next();
+
+      const Operand rhs = ParseOperand();
+      if (lhs.kind == Operand::Kind::kExpr || rhs.kind == Operand::Kind::kExpr) {
+        Fail("only fields and constants can be compared.");
+      }
+
+      const Op::Domain domain = ComparisonDomain(lhs, rhs);
+      EmitOperand(lhs, rhs, domain);
+      EmitOperand(rhs, lhs, domain);
+      Emit(Op{Op::Kind::kCompare, domain, compare});
+      return;
+    }
+
+    // Used alone: compare with zero.
+    if (lhs.kind == Operand::Kind::kExpr) return;
+    if (lhs.kind == Operand::Kind::kName) Fail(lhs.error);
+
+    const Category category = CategoryOf(lhs);
+    const Op::Domain domain = category == Category::kFloat    ? Op::Domain::kDouble
+                              : category == Category::kUint64 ? Op::Domain::kUint
+                                                              : Op::Domain::kInt;
+    EmitOperand(lhs, lhs, domain);
+    Emit(Op{Op::Kind::kConst, domain});
+    Emit(Op{Op::Kind::kCompare, domain, Op::Compare::kNe});
+  }
+
+  Operand ParseOperand() {
+    if (Accept("(")) {
+      ParseOr();
+      if (!Accept(")")) Fail("expected ')'.");
+      return Operand{Operand::Kind::kExpr};
+    }
+
+    const std::string_view token = Next();
+    if (token.empty()) Fail("unexpected end.");
+
+    const char c = token[0];
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.') {
+      return Operand{Operand::Kind::kNumber, token};
+    }
+    if (token == "true") return Operand{Operand::Kind::kNumber, "1"};
+    if (token == "false") return Operand{Operand::Kind::kNumber, "0"};
+    if (!std::isalpha(static_cast<unsigned char>(c)) && c != '_') {
+      Fail("unexpected \"" + std::string(token) + "\".");
+    }
+
+    try {
+      return Operand{Operand::Kind::kField, token, FieldAccessor::Compile(type_, token)};
+    } catch (const std::runtime_error& e) {
+      return Operand{Operand::Kind::kName, token, std::nullopt, e.what()};
+    }
+  }
+
+  Category CategoryOf(const Operand& operand) const {
+    using PrimType = TypeDescriptor::PrimType;
+
+    if (operand.kind == Operand::Kind::kName) return Category::kSigned;
+
+    if (operand.kind == Operand::Kind::kNumber) {
+      const std::string_view text = operand.text;
+      if (text.find_first_of(".eE") != std::string_view::npos) return Category::kFloat;
+      if (text[0] == '-') return Category::kSigned;
+
+      int64_t value;
+      const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+      return ec == std::errc::result_out_of_range ? Category::kUint64 : Category::kUnsigned;
+    }
+
+    if (operand.accessor->type().IsEnum()) return Category::kSigned;
+    switch (operand.accessor->prim_type()) {
+      case PrimType::kUint8:
+      case PrimType::kUint16:
+      case PrimType::kUint32:
+      case PrimType::kBool:
+        return Category::kUnsigned;
+      case PrimType::kUint64:
+        return operand.accessor->is_bitfield_field() ? Category::kUnsigned : Category::kUint64;
+      case PrimType::kInt8:
+      case PrimType::kInt16:
+      case PrimType::kInt32:
+      case PrimType::kInt64:
+        return Category::kSigned;
+      case PrimType::kFloat:
+      case PrimType::kDouble:
+        return Category::kFloat;
+    }
+    return Category::kSigned;
+  }
+
+  Op::Domain ComparisonDomain(const Operand& lhs, const Operand& rhs) const {
+    const Category a = CategoryOf(lhs);
+    const Category b = CategoryOf(rhs);
+
+    if (a == Category::kFloat || b == Category::kFloat) return Op::Domain::kDouble;
+    if (a == Category::kUint64 || b == Category::kUint64) {
+      if (a == Category::kSigned || b == Category::kSigned) return Op::Domain::kDouble;
+      return Op::Domain::kUint;
+    }
+    return Op::Domain::kInt;
+  }
+
+  // other is the operand operand is compared with (or operand itself), for enum value names.
+  void EmitOperand(const Operand& operand, const Operand& other, Op::Domain domain) {
+    if (operand.kind == Operand::Kind::kField) {
+      Op op{Op::Kind::kLoad, domain};
+      op.target = filter_.accessors_.size();
+      filter_.accessors_.push_back(*operand.accessor);
+      Emit(op);
+      return;
+    }
+
+    Op op{Op::Kind::kConst, domain};
+    if (operand.kind == Operand::Kind::kName) {
+      op.value.i = EnumValue(operand, other);
+    } else {
+      const char *begin = operand.text.data();
+      const char *end = begin + operand.text.size();
+      std::from_chars_result result;
+      switch (domain) {
+        case Op::Domain::kInt:
+          result = std::from_chars(begin, end, op.value.i);
+          break;
+        case Op::Domain::kUint:
+          result = std::from_chars(begin, end, op.value.u);
+          break;
+        case Op::Domain::kDouble:
+          result = std::from_chars(begin, end, op.value.d);
+          break;
+      }
+      if (result.ec != std::errc() || result.ptr != end) {
+        Fail("invalid number \"" + std::string(operand.text) + "\".");
+      }
+    }
+    Emit(op);
+  }
+
+  int64_t EnumValue(const Operand& name, const Operand& other) const {
+    if (other.kind != Operand::Kind::kField || !other.accessor->type().IsEnum()) Fail(name.error);
+
+    const std::vector<std::string>& values = other.accessor->type().enum_values();
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (values[i] == name.text) return i;
+    }
+    Fail("\"" + std::string(name.text) + "\" is not a value of \"" +
+         std::string(other.accessor->type().name()) + "\".");
+  }
+
+  Filter filter_;
+  const TypeDescriptor& type_;
+  std::string_view expr_;
+  size_t pos_ = 0;
+};
+
+}  // namespace impl
+
+Filter Filter::Compile(const TypeDescriptor& type, std::string_view expr) {
+  if (!type.IsStruct() || !type.struct_is_message()) {
+    throw std::runtime_error("Filter requires a message type.");
+  }
+  return impl::FilterCompiler(type, expr).Compile();
+}
+
+size_t Filter::Select(const uint8_t *const *buffers, const size_t *lens, size_t count,
+                      size_t *selected) const {
+  size_t num_selected = 0;
+  for (size_t i = 0; i < count; ++i) {
+    selected[num_selected] = i;
+    num_selected += Matches(buffers[i], lens[i]);
+  }
+  return num_selected;
+}
+
+bool Filter::Evaluate(const uint8_t *data) const {
+  Op::Value stack[kMaxDepth];
+  size_t top = 0;
+
+  const Op *ops = ops_.data();
+  for (size_t pc = 0; pc < ops_.size();) {
+    const Op& op = ops[pc++];
+    switch (op.kind) {
+      case Op::Kind::kLoad: {
+        const FieldAccessor& accessor = accessors_[op.target];
+        Op::Value& value = stack[top++];
+        switch (op.domain) {
+          case Op::Domain::kInt:
+            value.i = accessor.Convert<int64_t>(data);
+            break;
+          case Op::Domain::kUint:
+            value.u = accessor.Convert<uint64_t>(data);
+            break;
+          case Op::Domain::kDouble:
+            value.d = accessor.Convert<double>(data);
+            break;
+        }
+        break;
+      }
+      case Op::Kind::kConst:
+        stack[top++] = op.value;
+        break;
+      case Op::Kind::kCompare: {
+        const Op::Value rhs = stack[--top];
+        Op::Value& lhs = stack[top - 1];
+        switch (op.domain) {
+          case Op::Domain::kInt:
+            lhs.i = CompareValues(op.compare, lhs.i, rhs.i);
+            break;
+          case Op::Domain::kUint:
+            lhs.i = CompareValues(op.compare, lhs.u, rhs.u);
+            break;
+          case Op::Domain::kDouble:
+            lhs.i = CompareValues(op.compare, lhs.d, rhs.d);
+            break;
+        }
+        break;
+      }
+      case Op::Kind::kNot:
+        stack[top - 1].i = !stack[top - 1].i;
+        break;
+      case Op::Kind::kAndJump:
+        if (!stack[top - 1].i) {
+          pc = op.target;
+        } else {
+          --top;
+        }
+        break;
+      case Op::Kind::kOrJump:
+        if (stack[top - 1].i) {
+          pc = op.target;
+        } else {
+          --top;
+        }
+        break;
+    }
+  }
+
+  return stack[0].i;
+}
+
+}  // namespace dynamic
+}  // namespace ss
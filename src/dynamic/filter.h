@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "src/dynamic/field_accessor.h"
+#include "src/dynamic/packing.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace impl {
+
+class FilterCompiler;
+
+// One step of a Filter's stack program.
+struct FilterOp {
+  enum class Kind : uint8_t {
+    kLoad,     // Push a field, converted to domain.
+    kConst,    // Push value.
+    kCompare,  // Pop two values, push the result of comparing them (as an int).
+    kNot,      // Replace the top value with its negation.
+    kAndJump,  // If the top value is false jump to target, otherwise pop it.
+    kOrJump,   // If the top value is true jump to target, otherwise pop it.
+  };
+
+  // Type values are converted to before comparing.
+  enum class Domain : uint8_t {
+    kInt,
+    kUint,
+    kDouble,
+  };
+
+  enum class Compare : uint8_t {
+    kEq,
+    kNe,
+    kLt,
+    kLe,
+    kGt,
+    kGe,
+  };
+
+  union Value {
+    int64_t i;
+    uint64_t u;
+    double d;
+  };
+
+  Kind kind;
+  Domain domain = Domain::kInt;
+  Compare compare = Compare::kEq;
+  // Index into the Filter's accessors for kLoad, op index for kAndJump and kOrJump.
+  uint32_t target = 0;
+  Value value = {0};
+};
+
+}  // namespace impl
+
+// A predicate over packed messages of one type, e.g. "int32 > 50 && boolean", evaluated directly on
+// the packed bytes.  Only the referenced fields are read, and a buffer whose UID or length does not
+// match the type is rejected before any of them.
+//
+// Grammar:
+//   expr       := and ('||' and)*
+//   and        := unary ('&&' unary)*
+//   unary      := '!' unary | comparison
+//   comparison := operand (('==' | '!=' | '<' | '<=' | '>' | '>=') operand)?
+//   operand    := path | number | 'true' | 'false' | enum value name | '(' expr ')'
+// where path is a FieldAccessor path ("array_2d[1][2].field1", "bitfield.field0").  An operand
+// used alone is true if it is non-zero.  An enum value name is allowed when compared with a field
+// of that enum.
+//
+// Comparisons are done in double if either side is a float, in uint64 if either side is a uint64
+// and the other can not be negative, in double for uint64 against a signed operand, and in int64
+// otherwise.
+class Filter {
+ public:
+  // Throws std::runtime_error if type is not a message or expr is invalid.
+  static Filter Compile(const TypeDescriptor& type, std::string_view expr);
+
+  const TypeDescriptor& type() const { return *type_; }
+
+  bool Matches(const uint8_t *data, size_t len) const {
+    if (len != static_cast<size_t>(type_->packed_size())) return false;
+    // SsHeader: uid, then len.
+    if (UnpackBe<uint32_t>(data) != type_->uid()) return false;
+    return Evaluate(data);
+  }
+
+  // Writes the indices of the matching buffers to selected (which must have room for count), and
+  // returns how many there are.
+  size_t Select(const uint8_t *const *buffers, const size_t *lens, size_t count,
+                size_t *selected) const;
+
+ private:
+  friend class impl::FilterCompiler;
+
+  explicit Filter(const TypeDescriptor& type) : type_{&type} {}
+
+  bool Evaluate(const uint8_t *data) const;
+
+  const TypeDescriptor *type_;
+  std::vector<impl::FilterOp> ops_;
+  std::vector<FieldAccessor> accessors_;
+};
+
+}  // namespace dynamic
+}  // namespace ss
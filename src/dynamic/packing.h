@@ -5,6 +5,12 @@
 #include <cstring>
 #include <type_traits>
 
+#include "src/cpu_features.h"
+
+#ifdef SS_X86_64
+#include <immintrin.h>
+#endif
+
 namespace ss {
 namespace dynamic {
 namespace impl {
@@ -18,7 +24,10 @@ template <typename T>
 static inline T UnpackBe(const uint8_t *data) {
   T value;
 
-  if constexpr (sizeof(value) == 1) {
+  if constexpr (std::is_same_v<T, bool>) {
+    // Any nonzero byte is true; copying it into a bool could produce an invalid bool.
+    value = data[0] != 0;
+  } else if constexpr (sizeof(value) == 1) {
     uint8_t raw_value = data[0];
     memcpy(&value, &raw_value, sizeof(value));
   } else if constexpr (sizeof(value) == 2) {
@@ -106,5 +115,62 @@ static inline void PackBitfield(T data, U *dest, size_t bit_offset, size_t bit_s
   *dest |= raw_data << bit_offset;
 }
 
+// Mask of the bit_size bits at bit_offset of a bitfield container.
+static inline uint64_t BitfieldMask(size_t bit_offset, size_t bit_size) {
+  const uint64_t low = bit_size == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_size) - 1;
+  return low << bit_offset;
+}
+
+// The bits of raw under mask (a BitfieldMask at shift), moved down to bit 0.
+static inline uint64_t ExtractBits(uint64_t raw, uint64_t mask, size_t shift) {
+  return (raw & mask) >> shift;
+}
+
+// Inverse of ExtractBits: value moved up to shift and limited to mask.
+static inline uint64_t DepositBits(uint64_t value, uint64_t mask, size_t shift) {
+  return (value << shift) & mask;
+}
+
+#ifdef SS_X86_64
+
+namespace impl {
+
+// PSHUFB control reversing the bytes of each kSize byte element of a 16 byte vector.
+template <size_t kSize>
+struct ByteSwapShuffle {
+  constexpr ByteSwapShuffle() : bytes{} {
+    for (size_t i = 0; i < 16; ++i) {
+      bytes[i] = static_cast<uint8_t>(i / kSize * kSize + kSize - 1 - i % kSize);
+    }
+  }
+
+  alignas(16) uint8_t bytes[16];
+};
+
+}  // namespace impl
+
+// Reverses the bytes of each of count kSize byte values from src into dest, 16 bytes per shuffle,
+// converting a run of big endian values to host order or back.  Only whole vectors are swapped;
+// returns how many values that covered, leaving the rest (fewer than 16 / kSize) to the caller.
+// Callers must check GetCpuFeatures().ssse3.
+template <size_t kSize>
+__attribute__((target("ssse3"))) static inline uint32_t ByteSwapRunSsse3(const uint8_t *src,
+                                                                         uint8_t *dest,
+                                                                         uint32_t count) {
+  static_assert(kSize == 2 || kSize == 4 || kSize == 8);
+  static constexpr impl::ByteSwapShuffle<kSize> kShuffle;
+  constexpr uint32_t kPerVector = 16 / kSize;
+
+  const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(kShuffle.bytes));
+  const uint32_t num_swapped = count - count % kPerVector;
+  for (uint32_t i = 0; i < num_swapped; i += kPerVector) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * kSize));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i * kSize), _mm_shuffle_epi8(x, shuffle));
+  }
+  return num_swapped;
+}
+
+#endif  // SS_X86_64
+
 }  // namespace dynamic
 }  // namespace ss
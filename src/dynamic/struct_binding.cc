@@ -0,0 +1,132 @@
+#include "src/dynamic/struct_binding.h"
+
+#include <stdexcept>
+
+namespace ss {
+namespace dynamic {
+
+namespace {
+
+using impl::BoundShape;
+using impl::UnpackOp;
+
+class BindingCompiler {
+ public:
+  std::vector<UnpackOp> Compile(const BoundShape& shape, const TypeDescriptor& type) {
+    if (!type.IsStruct() && !type.IsBitfield()) {
+      throw std::runtime_error("StructBinding requires a struct or bitfield type.");
+    }
+    AddOps(shape, type, 0, 0, std::string(type.name()));
+    return std::move(ops_);
+  }
+
+ private:
+  [[noreturn]] static void Fail(const std::string& path, const char *reason) {
+    throw std::runtime_error("Binding for " + path + " " + reason + ".");
+  }
+
+  // Checks every bound member of shape names a distinct field of type.
+  static void CheckMembers(const BoundShape& shape, const TypeDescriptor& type,
+                           const std::string& path) {
+    for (size_t i = 0; i < shape.members.size(); ++i) {
+      const std::string& name = shape.members[i].name;
+      if (!type[name]) Fail(path + "." + name, "does not name a field");
+      for (size_t j = 0; j < i; ++j) {
+        if (shape.members[j].name == name) Fail(path + "." + name, "is bound twice");
+      }
+    }
+  }
+
+  static const impl::BoundMember *FindMember(const BoundShape& shape, std::string_view name) {
+    for (const impl::BoundMember& member : shape.members) {
+      if (member.name == name) return &member;
+    }
+    return nullptr;
+  }
+
+  void AddOps(const BoundShape& shape, const TypeDescriptor& type, uint32_t src_offset,
+              uint32_t dest_offset, const std::string& path) {
+    switch (type.type()) {
+      case TypeDescriptor::Type::kPrimitive:
+      case TypeDescriptor::Type::kEnum:
+        if (shape.kind != BoundShape::Kind::kPrimitive || shape.prim_type != type.prim_type()) {
+          Fail(path, "does not match its type");
+        }
+        AddPrimitive(type, src_offset, dest_offset);
+        return;
+
+      case TypeDescriptor::Type::kStruct:
+        if (shape.kind != BoundShape::Kind::kStruct) Fail(path, "is not a struct");
+        CheckMembers(shape, type, path);
+        for (const FieldDescriptor *field : type.struct_fields()) {
+          const impl::BoundMember *member = FindMember(shape, field->name());
+          if (!member) continue;
+          AddOps(*member->shape, field->type(), src_offset + field->offset(),
+                 dest_offset + member->offset, path + "." + member->name);
+        }
+        return;
+
+      case TypeDescriptor::Type::kBitfield: {
+        if (shape.kind != BoundShape::Kind::kStruct) Fail(path, "is not a struct");
+        CheckMembers(shape, type, path);
+        uint32_t remaining = shape.members.size();
+        for (const FieldDescriptor *field : type.struct_fields()) {
+          const impl::BoundMember *member = FindMember(shape, field->name());
+          if (!member) continue;
+          if (member->shape->kind != BoundShape::Kind::kPrimitive ||
+              member->shape->prim_type != field->type().prim_type()) {
+            Fail(path + "." + member->name, "does not match its type");
+          }
+          ops_.push_back({UnpackOp::Kind::kBitfield, field->type().prim_type(), type.prim_type(),
+                          static_cast<uint8_t>(field->bit_offset()),
+                          static_cast<uint8_t>(field->bit_size()), src_offset,
+                          dest_offset + member->offset, remaining--,
+                          BitfieldMask(field->bit_offset(), field->bit_size())});
+        }
+        return;
+      }
+
+      case TypeDescriptor::Type::kArray: {
+        if (shape.kind != BoundShape::Kind::kArray) Fail(path, "is not an array");
+        if (shape.array_size != type.array_size()) Fail(path, "does not match the array size");
+        const TypeDescriptor& elem = type.array_elem_type();
+        for (int i = 0; i < type.array_size(); ++i) {
+          AddOps(*shape.elem, elem, src_offset + i * elem.packed_size(),
+                 dest_offset + i * shape.elem->size, path + "[" + std::to_string(i) + "]");
+        }
+        return;
+      }
+    }
+  }
+
+  void AddPrimitive(const TypeDescriptor& type, uint32_t src_offset, uint32_t dest_offset) {
+    // Extend the previous op if this primitive directly follows it in both layouts.
+    if (!ops_.empty()) {
+      UnpackOp& prev = ops_.back();
+      if (prev.kind == UnpackOp::Kind::kPrimitive && prev.prim_type == type.prim_type() &&
+          prev.src_offset + prev.count * type.packed_size() == src_offset &&
+          prev.dest_offset + prev.count * type.value_size() == dest_offset) {
+        ++prev.count;
+        return;
+      }
+    }
+
+    ops_.push_back({UnpackOp::Kind::kPrimitive, type.prim_type(), type.prim_type(), 0, 0,
+                    src_offset, dest_offset, 1, 0});
+  }
+
+  std::vector<UnpackOp> ops_;
+};
+
+}  // namespace
+
+namespace impl {
+
+std::vector<UnpackOp> CompileBinding(const BoundShape& shape, const TypeDescriptor& type) {
+  return BindingCompiler().Compile(shape, type);
+}
+
+}  // namespace impl
+
+}  // namespace dynamic
+}  // namespace ss
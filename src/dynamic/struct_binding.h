@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/packing.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace impl {
+
+struct BoundShape;
+
+struct BoundMember {
+  std::string name;
+  uint32_t offset;
+  std::shared_ptr<const BoundShape> shape;
+};
+
+// The layout of a bound C++ type: an arithmetic or enum member, a C array or std::array, or a
+// user struct with its bound members.
+struct BoundShape {
+  enum class Kind : uint8_t {
+    kPrimitive,
+    kArray,
+    kStruct,
+  };
+
+  Kind kind;
+  // sizeof the C++ type.
+  uint32_t size;
+  // kPrimitive only; an enum's underlying type.
+  TypeDescriptor::PrimType prim_type;
+  // kArray only.
+  int array_size;
+  std::shared_ptr<const BoundShape> elem;
+  // kStruct only.
+  std::vector<BoundMember> members;
+};
+
+template <typename M>
+struct BoundArray {
+  static constexpr bool kIsArray = false;
+  using Leaf = M;
+};
+
+template <typename E, size_t N>
+struct BoundArray<E[N]> {
+  static constexpr bool kIsArray = true;
+  static constexpr size_t kSize = N;
+  using Elem = E;
+  using Leaf = typename BoundArray<E>::Leaf;
+};
+
+template <typename E, size_t N>
+struct BoundArray<std::array<E, N>> {
+  static constexpr bool kIsArray = true;
+  static constexpr size_t kSize = N;
+  using Elem = E;
+  using Leaf = typename BoundArray<E>::Leaf;
+};
+
+// Innermost element type of a (possibly nested) array member.
+template <typename M>
+using BoundLeaf = typename BoundArray<M>::Leaf;
+
+// Shape of M, with leaf the shape of its innermost element if that is a user struct.
+template <typename M>
+std::shared_ptr<const BoundShape> MakeBoundShape(const std::shared_ptr<const BoundShape>& leaf) {
+  if constexpr (!BoundArray<M>::kIsArray && !std::is_arithmetic_v<M> && !std::is_enum_v<M>) {
+    return leaf;
+  } else {
+    auto shape = std::make_shared<BoundShape>();
+    shape->size = sizeof(M);
+    if constexpr (BoundArray<M>::kIsArray) {
+      shape->kind = BoundShape::Kind::kArray;
+      shape->array_size = BoundArray<M>::kSize;
+      shape->elem = MakeBoundShape<typename BoundArray<M>::Elem>(leaf);
+    } else if constexpr (std::is_enum_v<M>) {
+      shape->kind = BoundShape::Kind::kPrimitive;
+      shape->prim_type = PrimTypeOf<std::underlying_type_t<M>>();
+    } else {
+      shape->kind = BoundShape::Kind::kPrimitive;
+      shape->prim_type = PrimTypeOf<M>();
+    }
+    return shape;
+  }
+}
+
+template <typename T, typename M>
+uint32_t MemberOffset(M T::*member) {
+  alignas(T) unsigned char storage[sizeof(T)] = {};
+  const T *object = reinterpret_cast<const T *>(storage);
+  return reinterpret_cast<const unsigned char *>(&(object->*member)) - storage;
+}
+
+// Validates shape against type and returns the UnpackOps decoding type straight into shape's
+// layout.  Throws std::runtime_error on any mismatch.
+std::vector<UnpackOp> CompileBinding(const BoundShape& shape, const TypeDescriptor& type);
+
+}  // namespace impl
+
+template <typename T>
+class StructBinding;
+
+// Decodes packed values of type() straight into a T, through a plan validated once by
+// StructBinding<T>::Compile.  Fields of type() without a binding are skipped.
+template <typename T>
+class BoundPlan {
+ public:
+  const TypeDescriptor& type() const { return *type_; }
+  impl::UnpackPlan plan() const { return impl::UnpackPlan(ops_.data(), ops_.size()); }
+
+  // Only the bound members of value are written.
+  void Unpack(const uint8_t *data, T *value) const {
+    impl::ExecuteUnpackPlan(plan(), data, reinterpret_cast<uint8_t *>(value));
+  }
+
+  // As above, first checking len and, for a message, its SsHeader.
+  UnpackStatus Unpack(const uint8_t *data, size_t len, T *value) const {
+    if (len != static_cast<size_t>(type_->packed_size())) return UnpackStatus::kInvalidLen;
+    if (type_->IsStruct() && type_->struct_is_message()) {
+      // SsHeader: uid, then len.
+      if (UnpackBe<uint16_t>(data + 4) != len) return UnpackStatus::kInvalidLen;
+      if (UnpackBe<uint32_t>(data) != type_->uid()) return UnpackStatus::kInvalidUid;
+    }
+    Unpack(data, value);
+    return UnpackStatus::kSuccess;
+  }
+
+  // Packs the bound members of value into data (type().packed_size() bytes), leaving the bytes of
+  // unbound fields unchanged; unbound bitfield fields are packed as zero.  A message's SsHeader uid
+  // and len are filled in, as PackMessage does.
+  void Pack(const T& value, uint8_t *data) const {
+    impl::ExecutePackPlan(plan(), reinterpret_cast<const uint8_t *>(&value), data);
+    if (type_->IsStruct() && type_->struct_is_message()) {
+      PackBe<uint32_t>(type_->uid(), data);
+      PackBe<uint16_t>(type_->packed_size(), data + 4);
+    }
+  }
+
+ private:
+  friend class StructBinding<T>;
+
+  BoundPlan(const TypeDescriptor& type, std::vector<impl::UnpackOp> ops)
+      : type_{&type}, ops_{std::move(ops)} {}
+
+  const TypeDescriptor *type_;
+  std::vector<impl::UnpackOp> ops_;
+};
+
+// Maps the fields of a runtime struct or bitfield type onto the members of a user defined T, for
+// code that knows its layout at compile time but gets the spec at runtime:
+//
+//   StructBinding<Point> point;
+//   point.Bind("x", &Point::x).Bind("y", &Point::y);
+//   StructBinding<Sample> sample;
+//   sample.Bind("count", &Sample::count).Bind("points", &Sample::points, point);
+//   const BoundPlan<Sample> plan = sample.Compile(*types["Sample"]);
+//   plan.Unpack(data, len, &my_sample);
+//
+// Arithmetic members bind primitives of exactly the same type, enum members (or integers) enums
+// of the same underlying type, and C arrays / std::arrays arrays of the same size.  Struct and
+// bitfield fields, or arrays of them, bind to a member of (arrays of) another bound struct.
+template <typename T>
+class StructBinding {
+ public:
+  static_assert(std::is_trivially_copyable_v<T>, "Bound structs are written bytewise.");
+
+  StructBinding() : shape_{std::make_shared<impl::BoundShape>()} {
+    shape_->kind = impl::BoundShape::Kind::kStruct;
+    shape_->size = sizeof(T);
+  }
+
+  // Binds the field name to an arithmetic or enum member, or an array of them.
+  template <typename M>
+  StructBinding& Bind(std::string_view name, M T::*member) {
+    using Leaf = impl::BoundLeaf<M>;
+    static_assert(std::is_arithmetic_v<Leaf> || std::is_enum_v<Leaf>,
+                  "Struct members are bound with Bind(name, member, binding).");
+    shape_->members.push_back(
+        {std::string(name), impl::MemberOffset(member), impl::MakeBoundShape<M>(nullptr)});
+    return *this;
+  }
+
+  // Binds the field name to a struct member, or an array of them, laid out per binding.  binding
+  // is copied, so later changes to it do not apply here.
+  template <typename M, typename U>
+  StructBinding& Bind(std::string_view name, M T::*member, const StructBinding<U>& binding) {
+    static_assert(std::is_same_v<impl::BoundLeaf<M>, U>, "Member does not match binding.");
+    const auto leaf = std::make_shared<const impl::BoundShape>(*binding.shape_);
+    shape_->members.push_back(
+        {std::string(name), impl::MemberOffset(member), impl::MakeBoundShape<M>(leaf)});
+    return *this;
+  }
+
+  // Throws std::runtime_error if type is not a struct or bitfield, a bound name is not one of its
+  // fields (or is bound twice), or a member does not match its field.
+  BoundPlan<T> Compile(const TypeDescriptor& type) const {
+    return BoundPlan<T>(type, impl::CompileBinding(*shape_, type));
+  }
+
+ private:
+  template <typename U>
+  friend class StructBinding;
+
+  std::shared_ptr<impl::BoundShape> shape_;
+};
+
+}  // namespace dynamic
+}  // namespace ss
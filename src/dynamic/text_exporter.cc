@@ -0,0 +1,281 @@
+#include "src/dynamic/text_exporter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "src/dynamic/packing.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace {
+
+// Longest text std::to_chars produces for any primitive: "-1.7976931348623157e+308".
+constexpr size_t kMaxNumberSize = 24;
+
+char *WriteLiteral(char *out, std::string_view literal) {
+  memcpy(out, literal.data(), literal.size());
+  return out + literal.size();
+}
+
+template <typename T>
+char *WriteNumber(char *out, T value) {
+  return std::to_chars(out, out + kMaxNumberSize, value).ptr;
+}
+
+template <typename T>
+char *WriteFloat(char *out, T value, TextExporter::Format format) {
+  if (std::isfinite(value)) return WriteNumber(out, value);
+  if (format == TextExporter::Format::kJsonLines) return WriteLiteral(out, "null");
+  if (std::isnan(value)) return WriteLiteral(out, "nan");
+  return WriteLiteral(out, value < 0 ? "-inf" : "inf");
+}
+
+}  // namespace
+
+// Fields selected by TextExporter::Project, as '.' separated paths.
+struct TextExporter::Projection {
+  enum class Match {
+    kNone,
+    kAll,
+    kPartial,
+  };
+
+  Match Find(const std::string& field_path) const {
+    Match match = Match::kNone;
+    for (const std::string& path : paths) {
+      if (path == field_path) return Match::kAll;
+      if (path.size() > field_path.size() && path.compare(0, field_path.size(), field_path) == 0 &&
+          path[field_path.size()] == '.') {
+        match = Match::kPartial;
+      }
+    }
+    return match;
+  }
+
+  std::vector<std::string> paths;
+};
+
+TextExporter::TextExporter(Format format, Sink sink, size_t buffer_size)
+    : format_{format},
+      sink_{std::move(sink)},
+      buffer_{new char[buffer_size]},
+      capacity_{buffer_size} {}
+
+void TextExporter::Project(const TypeDescriptor& type, const std::vector<std::string>& paths) {
+  if (programs_.count(&type)) {
+    throw std::runtime_error("\"" + std::string(type.name()) + "\" is already compiled.");
+  }
+
+  for (const std::string& path : paths) {
+    const TypeDescriptor *parent = &type;
+    size_t pos = 0;
+    while (true) {
+      const size_t end = std::min(path.find('.', pos), path.size());
+      if (!parent->IsStruct() && !parent->IsBitfield()) parent = nullptr;
+      const FieldDescriptor *field = parent ? (*parent)[path.substr(pos, end - pos)] : nullptr;
+      if (!field) throw std::runtime_error("Invalid projection path \"" + path + "\".");
+
+      if (end == path.size()) break;
+      parent = &field->type();
+      while (parent->IsArray()) parent = &parent->array_elem_type();
+      pos = end + 1;
+    }
+  }
+
+  const Projection projection{paths};
+  Compile(type, &projection);
+}
+
+void TextExporter::Write(const TypeDescriptor& type, const uint8_t *data) {
+  const auto it = programs_.find(&type);
+  Program& program = it != programs_.end() ? it->second : Compile(type, nullptr);
+
+  if (!program.header.empty()) {
+    Reserve(program.header.size());
+    memcpy(buffer_.get() + size_, program.header.data(), program.header.size());
+    size_ += program.header.size();
+    program.header.clear();
+  }
+
+  if (size_ + program.max_size > capacity_) Flush();
+
+  const char *text = program.text.data();
+  char *out = buffer_.get() + size_;
+  for (const Leaf& leaf : program.leaves) {
+    out = WriteLiteral(out, std::string_view(text + leaf.literal_offset, leaf.literal_size));
+    out = WriteValue(leaf, data, out);
+  }
+  out = WriteLiteral(out, std::string_view(program.text).substr(program.tail_offset));
+
+  size_ = out - buffer_.get();
+}
+
+void TextExporter::Flush() {
+  if (size_) sink_(buffer_.get(), size_);
+  size_ = 0;
+}
+
+// Flushes if size more bytes do not fit, and grows the buffer if they never would.
+void TextExporter::Reserve(size_t size) {
+  if (size_ + size <= capacity_) return;
+
+  Flush();
+  if (size > capacity_) {
+    buffer_.reset(new char[size]);
+    capacity_ = size;
+  }
+}
+
+TextExporter::Program& TextExporter::Compile(const TypeDescriptor& type,
+                                             const Projection *projection) {
+  if (!type.IsStruct()) throw std::runtime_error("TextExporter requires a struct type.");
+
+  Program program;
+  std::string literal;
+  if (format_ == Format::kJsonLines) literal = "{\"" + std::string(type.name()) + "\":";
+
+  AddLeaves(program, literal, type, type, "", "", projection);
+
+  literal += format_ == Format::kJsonLines ? "}\n" : "\n";
+  program.tail_offset = program.text.size();
+  program.text += literal;
+  program.max_size += literal.size();
+
+  if (format_ == Format::kCsv) program.header += '\n';
+
+  // A row must always fit in an empty buffer.
+  Reserve(program.max_size);
+  return programs_.insert_or_assign(&type, std::move(program)).first->second;
+}
+
+// Walks type depth first, accumulating JSON punctuation in literal until the next leaf.  path is
+// the FieldAccessor path of type, field_path the same without array indices (for projection).
+void TextExporter::AddLeaves(Program& program, std::string& literal, const TypeDescriptor& root,
+                             const TypeDescriptor& type, const std::string& path,
+                             const std::string& field_path, const Projection *projection) {
+  const bool json = format_ == Format::kJsonLines;
+
+  if (type.IsArray()) {
+    if (json) literal += '[';
+    for (int i = 0; i < type.array_size(); ++i) {
+      if (json && i != 0) literal += ',';
+      AddLeaves(program, literal, root, type.array_elem_type(),
+                path + "[" + std::to_string(i) + "]", field_path, projection);
+    }
+    if (json) literal += ']';
+    return;
+  }
+
+  if (type.IsStruct() || type.IsBitfield()) {
+    if (json) literal += '{';
+    bool first = true;
+    for (const FieldDescriptor *field : type.struct_fields()) {
+      const std::string name(field->name());
+      const std::string child_field_path = field_path.empty() ? name : field_path + "." + name;
+
+      const Projection *field_projection = projection;
+      if (projection) {
+        const Projection::Match match = projection->Find(child_field_path);
+        if (match == Projection::Match::kNone) continue;
+        if (match == Projection::Match::kAll) field_projection = nullptr;
+      }
+
+      if (json) {
+        if (!first) literal += ',';
+        literal += "\"" + name + "\":";
+      }
+      first = false;
+
+      AddLeaves(program, literal, root, field->type(), path.empty() ? name : path + "." + name,
+                child_field_path, field_projection);
+    }
+    if (json) literal += '}';
+    return;
+  }
+
+  AddLeaf(program, literal, root, type, path);
+}
+
+void TextExporter::AddLeaf(Program& program, std::string& literal, const TypeDescriptor& root,
+                           const TypeDescriptor& type, const std::string& path) {
+  if (format_ == Format::kCsv) {
+    if (!program.leaves.empty()) {
+      literal += ',';
+      program.header += ',';
+    }
+    program.header += path;
+  }
+
+  const FieldAccessor accessor = FieldAccessor::Compile(root, path);
+  const Leaf leaf{static_cast<uint32_t>(program.text.size()),
+                  static_cast<uint32_t>(literal.size()),
+                  accessor.offset(),
+                  type.prim_type(),
+                  accessor.is_bitfield_field(),
+                  type.IsEnum() ? &type : nullptr,
+                  accessor};
+
+  size_t value_size = kMaxNumberSize;
+  if (leaf.enum_type) {
+    for (std::string_view name : type.enum_values()) {
+      value_size = std::max(value_size, name.size() + 2);
+    }
+  }
+
+  program.text += literal;
+  program.max_size += literal.size() + value_size;
+  program.leaves.push_back(leaf);
+  literal.clear();
+}
+
+char *TextExporter::WriteValue(const Leaf& leaf, const uint8_t *data, char *out) const {
+  if (leaf.is_bitfield_field) return WriteNumber(out, leaf.accessor.Convert<uint64_t>(data));
+
+  const uint8_t *value = data + leaf.offset;
+  if (leaf.enum_type) {
+    const int64_t index = impl::UnpackConvert<int64_t>(leaf.prim_type, value);
+    const std::vector<std::string>& names = leaf.enum_type->enum_values();
+    if (index < 0 || static_cast<uint64_t>(index) >= names.size()) return WriteNumber(out, index);
+
+    const bool json = format_ == Format::kJsonLines;
+    if (json) *out++ = '"';
+    out = WriteLiteral(out, names[index]);
+    if (json) *out++ = '"';
+    return out;
+  }
+
+  switch (leaf.prim_type) {
+    case PrimType::kUint8:
+      return WriteNumber(out, UnpackBe<uint8_t>(value));
+    case PrimType::kUint16:
+      return WriteNumber(out, UnpackBe<uint16_t>(value));
+    case PrimType::kUint32:
+      return WriteNumber(out, UnpackBe<uint32_t>(value));
+    case PrimType::kUint64:
+      return WriteNumber(out, UnpackBe<uint64_t>(value));
+    case PrimType::kInt8:
+      return WriteNumber(out, UnpackBe<int8_t>(value));
+    case PrimType::kInt16:
+      return WriteNumber(out, UnpackBe<int16_t>(value));
+    case PrimType::kInt32:
+      return WriteNumber(out, UnpackBe<int32_t>(value));
+    case PrimType::kInt64:
+      return WriteNumber(out, UnpackBe<int64_t>(value));
+    case PrimType::kBool:
+      return WriteLiteral(out, UnpackBe<bool>(value) ? "true" : "false");
+    case PrimType::kFloat:
+      return WriteFloat(out, UnpackBe<float>(value), format_);
+    case PrimType::kDouble:
+      return WriteFloat(out, UnpackBe<double>(value), format_);
+  }
+
+  return out;
+}
+
+}  // namespace dynamic
+}  // namespace ss
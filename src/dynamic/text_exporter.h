@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/field_accessor.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+// Writes packed values as JSON lines or CSV rows straight from their bytes.  Each type is compiled
+// once, the first time it is written, into a list of leaves (primitive, enum or bitfield field),
+// each preceded by the literal text (keys, brackets, separators) that comes before it, so writing a
+// row is a run of memcpys and number formatting into one reusable buffer.
+//
+// JSON lines: {"TypeName":{...}} per value, structs and bitfields as objects, arrays as arrays,
+// enums as their value name (or number if out of range), non-finite floats as null.
+//
+// CSV: one column per leaf, named by its FieldAccessor path (e.g. "array_2d[1][2].field1").  A
+// header row is written before the first row of each type, so a CSV exporter is meant to see one
+// type; split mixed streams by type first.
+class TextExporter {
+ public:
+  enum class Format {
+    kJsonLines,
+    kCsv,
+  };
+
+  // Receives output whenever the buffer fills, and on Flush().
+  using Sink = std::function<void(const char *data, size_t size)>;
+
+  explicit TextExporter(Format format, Sink sink, size_t buffer_size = 1 << 20);
+  ~TextExporter() { Flush(); }
+
+  TextExporter(const TextExporter&) = delete;
+  TextExporter& operator=(const TextExporter&) = delete;
+
+  // Restricts type's output to the given fields and their children.  Paths name struct and
+  // bitfield fields separated by '.', without array indices: "array_1d.field0" selects field0 of
+  // every element.  Throws std::runtime_error if a path does not resolve, or if type was already
+  // written or projected.
+  void Project(const TypeDescriptor& type, const std::vector<std::string>& paths);
+
+  // Writes one packed value of type (a struct).
+  void Write(const TypeDescriptor& type, const uint8_t *data);
+
+  // Validates a packed message as UnpackMessage does and writes it on success.
+  template <typename Types>
+  UnpackStatus WriteMessage(const uint8_t *data, size_t len, const Types& types) {
+    const auto [msg_type, status] = impl::CheckMessage(data, len, types);
+    if (msg_type) Write(*msg_type, data);
+    return status;
+  }
+
+  // Hands everything written so far to the sink.
+  void Flush();
+
+ private:
+  using PrimType = TypeDescriptor::PrimType;
+
+  struct Leaf {
+    // Literal text written before the value, in Program::text.
+    uint32_t literal_offset;
+    uint32_t literal_size;
+    uint32_t offset;
+    PrimType prim_type;
+    bool is_bitfield_field;
+    const TypeDescriptor *enum_type;  // nullptr unless the leaf is an enum.
+    FieldAccessor accessor;
+  };
+
+  struct Program {
+    std::string text;
+    std::vector<Leaf> leaves;
+    // Literal text after the last leaf, in text.
+    uint32_t tail_offset = 0;
+    // Upper bound on the length of one row.
+    size_t max_size = 0;
+    std::string header;
+  };
+
+  struct Projection;
+
+  Program& Compile(const TypeDescriptor& type, const Projection *projection);
+  void AddLeaves(Program& program, std::string& literal, const TypeDescriptor& root,
+                 const TypeDescriptor& type, const std::string& path, const std::string& field_path,
+                 const Projection *projection);
+  void AddLeaf(Program& program, std::string& literal, const TypeDescriptor& root,
+               const TypeDescriptor& type, const std::string& path);
+  char *WriteValue(const Leaf& leaf, const uint8_t *data, char *out) const;
+  void Reserve(size_t size);
+
+  Format format_;
+  Sink sink_;
+  std::unique_ptr<char[]> buffer_;
+  size_t capacity_;
+  size_t size_ = 0;
+  std::unordered_map<const TypeDescriptor *, Program> programs_;
+};
+
+}  // namespace dynamic
+}  // namespace ss
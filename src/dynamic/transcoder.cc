@@ -0,0 +1,303 @@
+#include "src/dynamic/transcoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "src/dynamic/field_accessor.h"
+#include "src/dynamic/packing.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace {
+
+using Op = impl::TranscodeOp;
+using PrimType = TypeDescriptor::PrimType;
+
+bool IsFloat(PrimType prim_type) {
+  return prim_type == PrimType::kFloat || prim_type == PrimType::kDouble;
+}
+
+bool IsSigned(PrimType prim_type) {
+  return prim_type == PrimType::kInt8 || prim_type == PrimType::kInt16 ||
+         prim_type == PrimType::kInt32 || prim_type == PrimType::kInt64;
+}
+
+int IntBits(PrimType prim_type) {
+  switch (prim_type) {
+    case PrimType::kUint8:
+    case PrimType::kInt8:
+      return 8;
+    case PrimType::kUint16:
+    case PrimType::kInt16:
+      return 16;
+    case PrimType::kUint32:
+    case PrimType::kInt32:
+      return 32;
+    case PrimType::kUint64:
+    case PrimType::kInt64:
+      return 64;
+    default:
+      return 0;
+  }
+}
+
+// Whether every value of from is exactly representable in to.
+bool Widens(PrimType from, PrimType to) {
+  if (from == PrimType::kBool || to == PrimType::kBool) return false;
+
+  if (to == PrimType::kDouble) return from == PrimType::kFloat || IntBits(from) <= 32;
+  if (to == PrimType::kFloat) return !IsFloat(from) && IntBits(from) <= 16;
+  if (IsFloat(from)) return false;
+  if (IsSigned(from) && !IsSigned(to)) return false;
+  return IntBits(to) > IntBits(from);
+}
+
+// static_casts value to prim_type and packs it big endian.
+template <typename T>
+void PackConvert(PrimType prim_type, T value, uint8_t *data) {
+  switch (prim_type) {
+    case PrimType::kUint8:
+      PackBe(static_cast<uint8_t>(value), data);
+      break;
+    case PrimType::kUint16:
+      PackBe(static_cast<uint16_t>(value), data);
+      break;
+    case PrimType::kUint32:
+      PackBe(static_cast<uint32_t>(value), data);
+      break;
+    case PrimType::kUint64:
+      PackBe(static_cast<uint64_t>(value), data);
+      break;
+    case PrimType::kInt8:
+      PackBe(static_cast<int8_t>(value), data);
+      break;
+    case PrimType::kInt16:
+      PackBe(static_cast<int16_t>(value), data);
+      break;
+    case PrimType::kInt32:
+      PackBe(static_cast<int32_t>(value), data);
+      break;
+    case PrimType::kInt64:
+      PackBe(static_cast<int64_t>(value), data);
+      break;
+    case PrimType::kBool:
+      PackBe(static_cast<bool>(value), data);
+      break;
+    case PrimType::kFloat:
+      PackBe(static_cast<float>(value), data);
+      break;
+    case PrimType::kDouble:
+      PackBe(static_cast<double>(value), data);
+      break;
+  }
+}
+
+class PlanCompiler {
+ public:
+  explicit PlanCompiler(impl::TranscodePlan& plan) : plan_{plan} {}
+
+  void Compile() {
+    AddOps(*plan_.from, 0, *plan_.to, 0);
+    plan_.zero = plan_.zero || covered_ != static_cast<size_t>(plan_.to->packed_size());
+  }
+
+ private:
+  void AddCopy(uint32_t src_offset, uint32_t dest_offset, uint32_t size) {
+    covered_ += size;
+
+    if (!plan_.ops.empty()) {
+      Op& last = plan_.ops.back();
+      if (last.kind == Op::Kind::kCopy && last.src_offset + last.size == src_offset &&
+          last.dest_offset + last.size == dest_offset) {
+        last.size += size;
+        return;
+      }
+    }
+
+    Op op{Op::Kind::kCopy};
+    op.src_offset = src_offset;
+    op.dest_offset = dest_offset;
+    op.size = size;
+    plan_.ops.push_back(op);
+  }
+
+  void AddOps(const TypeDescriptor& from, uint32_t src_offset, const TypeDescriptor& to,
+              uint32_t dest_offset) {
+    if (from.uid() == to.uid() && from.packed_size() == to.packed_size()) {
+      AddCopy(src_offset, dest_offset, to.packed_size());
+      return;
+    }
+
+    if (from.type() != to.type()) return;
+
+    switch (to.type()) {
+      case TypeDescriptor::Type::kPrimitive:
+        if (from.prim_type() == to.prim_type()) {
+          AddCopy(src_offset, dest_offset, to.packed_size());
+        } else if (Widens(from.prim_type(), to.prim_type())) {
+          Op op{Op::Kind::kConvert, from.prim_type(), to.prim_type()};
+          op.src_offset = src_offset;
+          op.dest_offset = dest_offset;
+          plan_.ops.push_back(op);
+          covered_ += to.packed_size();
+        }
+        break;
+
+      case TypeDescriptor::Type::kEnum:
+        AddEnum(from, src_offset, to, dest_offset);
+        break;
+
+      case TypeDescriptor::Type::kStruct:
+        for (const FieldDescriptor *to_field : to.struct_fields()) {
+          const FieldDescriptor *from_field = from[to_field->name()];
+          if (!from_field) continue;
+          AddOps(from_field->type(), src_offset + from_field->offset(), to_field->type(),
+                 dest_offset + to_field->offset());
+        }
+        break;
+
+      case TypeDescriptor::Type::kBitfield:
+        plan_.zero = true;
+        for (const FieldDescriptor *to_field : to.struct_fields()) {
+          const FieldDescriptor *from_field = from[to_field->name()];
+          if (!from_field || from_field->bit_size() > to_field->bit_size()) continue;
+
+          Op op{Op::Kind::kBitfield, from.prim_type(), to.prim_type(),
+                static_cast<uint8_t>(from_field->bit_offset()),
+                static_cast<uint8_t>(to_field->bit_offset())};
+          op.src_offset = src_offset;
+          op.dest_offset = dest_offset;
+          op.mask = BitfieldMask(from_field->bit_offset(), from_field->bit_size());
+          plan_.ops.push_back(op);
+        }
+        break;
+
+      case TypeDescriptor::Type::kArray: {
+        const TypeDescriptor& from_elem = from.array_elem_type();
+        const TypeDescriptor& to_elem = to.array_elem_type();
+        for (int i = 0; i < std::min(from.array_size(), to.array_size()); ++i) {
+          AddOps(from_elem, src_offset + i * from_elem.packed_size(), to_elem,
+                 dest_offset + i * to_elem.packed_size());
+        }
+        break;
+      }
+    }
+  }
+
+  void AddEnum(const TypeDescriptor& from, uint32_t src_offset, const TypeDescriptor& to,
+               uint32_t dest_offset) {
+    const std::vector<std::string>& from_values = from.enum_values();
+    const std::vector<std::string>& to_values = to.enum_values();
+
+    // Values only appended: the numbers are unchanged.
+    if (from_values.size() <= to_values.size() &&
+        std::equal(from_values.begin(), from_values.end(), to_values.begin())) {
+      if (from.prim_type() == to.prim_type()) {
+        AddCopy(src_offset, dest_offset, to.packed_size());
+        return;
+      }
+      if (Widens(from.prim_type(), to.prim_type())) {
+        Op op{Op::Kind::kConvert, from.prim_type(), to.prim_type()};
+        op.src_offset = src_offset;
+        op.dest_offset = dest_offset;
+        plan_.ops.push_back(op);
+        covered_ += to.packed_size();
+        return;
+      }
+    }
+
+    Op op{Op::Kind::kEnum, from.prim_type(), to.prim_type()};
+    op.src_offset = src_offset;
+    op.dest_offset = dest_offset;
+    op.size = from_values.size();
+    op.table = plan_.enum_values.size();
+    for (std::string_view name : from_values) {
+      const auto it = std::find(to_values.begin(), to_values.end(), name);
+      plan_.enum_values.push_back(it == to_values.end() ? 0 : it - to_values.begin());
+    }
+    plan_.ops.push_back(op);
+    covered_ += to.packed_size();
+  }
+
+  impl::TranscodePlan& plan_;
+  size_t covered_ = 0;
+};
+
+}  // namespace
+
+Transcoder::Transcoder(const DescriptorBuilder& from, const DescriptorBuilder& to) {
+  for (const auto& [name, from_type] : from.types()) {
+    if (!from_type->IsStruct() || !from_type->struct_is_message()) continue;
+
+    const TypeDescriptor *to_type = to[name];
+    if (!to_type || !to_type->IsStruct() || !to_type->struct_is_message()) continue;
+
+    impl::TranscodePlan& plan = plans_[from_type->uid()];
+    plan.from = from_type;
+    plan.to = to_type;
+    PlanCompiler(plan).Compile();
+  }
+}
+
+size_t Transcoder::Transcode(const uint8_t *data, size_t len, uint8_t *out,
+                             size_t out_len) const {
+  if (len < 6) return 0;
+
+  // SsHeader: uid, then len.
+  const impl::TranscodePlan *msg_plan = plan(UnpackBe<uint32_t>(data));
+  if (!msg_plan || UnpackBe<uint16_t>(data + 4) != len ||
+      len != static_cast<size_t>(msg_plan->from->packed_size())) {
+    return 0;
+  }
+
+  const size_t out_size = msg_plan->to->packed_size();
+  if (out_len < out_size) return 0;
+
+  if (msg_plan->zero) memset(out, 0, out_size);
+
+  for (const Op& op : msg_plan->ops) {
+    const uint8_t *src = data + op.src_offset;
+    uint8_t *dest = out + op.dest_offset;
+
+    switch (op.kind) {
+      case Op::Kind::kCopy:
+        memcpy(dest, src, op.size);
+        break;
+
+      case Op::Kind::kConvert:
+        if (IsFloat(op.dest_type)) {
+          PackConvert(op.dest_type, impl::UnpackConvert<double>(op.src_type, src), dest);
+        } else if (IsSigned(op.src_type)) {
+          PackConvert(op.dest_type, impl::UnpackConvert<int64_t>(op.src_type, src), dest);
+        } else {
+          PackConvert(op.dest_type, impl::UnpackConvert<uint64_t>(op.src_type, src), dest);
+        }
+        break;
+
+      case Op::Kind::kEnum: {
+        const int64_t value = impl::UnpackConvert<int64_t>(op.src_type, src);
+        const bool mapped = value >= 0 && value < op.size;
+        PackConvert(op.dest_type, mapped ? msg_plan->enum_values[op.table + value] : 0, dest);
+        break;
+      }
+
+      case Op::Kind::kBitfield: {
+        const uint64_t bits = (impl::UnpackConvert<uint64_t>(op.src_type, src) & op.mask) >>
+                              op.src_shift;
+        const uint64_t container = impl::UnpackConvert<uint64_t>(op.dest_type, dest);
+        PackConvert(op.dest_type, container | bits << op.dest_shift, dest);
+        break;
+      }
+    }
+  }
+
+  PackBe<uint32_t>(msg_plan->to->uid(), out);
+  PackBe<uint16_t>(out_size, out + 4);
+
+  return out_size;
+}
+
+}  // namespace dynamic
+}  // namespace ss
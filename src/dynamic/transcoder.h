@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+namespace impl {
+
+// One step of a TranscodePlan.  kCopy copies size bytes unchanged.  kConvert widens the primitive
+// of src_type to dest_type.  kEnum maps the src_type value through the size entries of the plan's
+// enum_values starting at table (values outside map to 0).  kBitfield moves the bits under mask of
+// src_type's container, shifted down by src_shift, to dest_shift of dest_type's container.
+struct TranscodeOp {
+  enum class Kind : uint8_t {
+    kCopy,
+    kConvert,
+    kEnum,
+    kBitfield,
+  };
+
+  Kind kind;
+  TypeDescriptor::PrimType src_type = TypeDescriptor::PrimType::kUint8;
+  TypeDescriptor::PrimType dest_type = TypeDescriptor::PrimType::kUint8;
+  uint8_t src_shift = 0;
+  uint8_t dest_shift = 0;
+  uint32_t src_offset = 0;
+  uint32_t dest_offset = 0;
+  uint32_t size = 0;
+  uint32_t table = 0;
+  uint64_t mask = 0;
+};
+
+struct TranscodePlan {
+  const TypeDescriptor *from;
+  const TypeDescriptor *to;
+  std::vector<TranscodeOp> ops;
+  std::vector<int64_t> enum_values;
+  // Set if the ops do not write every byte of to, so the output is zeroed first.
+  bool zero = false;
+};
+
+}  // namespace impl
+
+// Rewrites messages packed under one spec into the same messages under another, e.g. archives
+// recorded before a message definition changed.  Messages are matched by name, then fields by name
+// and kind, recursively:
+//
+//   - Types with equal UIDs are copied as is.
+//   - Primitives are copied, or widened when the new type holds every old value (e.g. uint8 to
+//     int16, int32 to double).  Narrowing changes are not matched.
+//   - Enums are mapped by value name.  Old values without a new name become 0.
+//   - Bitfield fields are matched by name when the new field is at least as wide.
+//   - Arrays transcode their common prefix of elements.
+//
+// Everything in the new message that is not matched is 0, and SsHeader holds the new UID and
+// length.  Each message's plan is compiled once, and adjacent unchanged fields are merged into a
+// single copy, so an unchanged message is one memcpy.  Both specs must outlive the transcoder.
+class Transcoder {
+ public:
+  Transcoder(const DescriptorBuilder& from, const DescriptorBuilder& to);
+
+  // Plan for a message of the old spec, nullptr if the UID is unknown or the message has no
+  // counterpart in the new spec.
+  const impl::TranscodePlan *plan(uint32_t msg_uid) const {
+    const auto it = plans_.find(msg_uid);
+    if (it == plans_.end()) return nullptr;
+    return &it->second;
+  }
+
+  // Transcodes a packed message of the old spec into out.  Returns the number of bytes written, or
+  // 0 if data is not a valid message with a plan, or out_len is too short.
+  size_t Transcode(const uint8_t *data, size_t len, uint8_t *out, size_t out_len) const;
+
+ private:
+  std::unordered_map<uint32_t, impl::TranscodePlan> plans_;
+};
+
+}  // namespace dynamic
+}  // namespace ss
@@ -1,32 +1,135 @@
 #include "src/dynamic/type_descriptors.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <yaml-cpp/yaml.h>
 
+#include "src/crc32.h"
+#include "src/dynamic/packing.h"
+
 namespace ss {
 namespace dynamic {
 
 using Type = TypeDescriptor::Type;
 using PrimType = TypeDescriptor::PrimType;
 
-const TypeDescriptor& DescriptorBuilder::ParseStruct(std::string_view name, const YAML::Node& node,
-                                                     bool is_msg) {
-  std::unique_ptr<StructDescriptor> structure(new StructDescriptor(name, is_msg));
+namespace {
+
+int PrimPackedSize(PrimType prim_type) {
+  switch (prim_type) {
+    case PrimType::kUint8:
+    case PrimType::kInt8:
+    case PrimType::kBool:
+      return 1;
+    case PrimType::kUint16:
+    case PrimType::kInt16:
+      return 2;
+    case PrimType::kUint32:
+    case PrimType::kInt32:
+    case PrimType::kFloat:
+      return 4;
+    case PrimType::kUint64:
+    case PrimType::kInt64:
+    case PrimType::kDouble:
+      return 8;
+  }
 
-  // Add implicit SsHeader struct to messages.
-  if (is_msg) {
-    structure->AddField("ss_header", *type_map_.at("SsHeader").get());
+  throw std::runtime_error("Unknown prim_type.");
+}
+
+uint32_t AlignUp(uint32_t value, uint32_t align) {
+  return (value + align - 1) / align * align;
+}
+
+// Sizes and offsets are held as int, so anything that doesn't fit in one is rejected.
+int CheckedSize(uint64_t size) {
+  if (size > INT_MAX) throw std::runtime_error("Type too large.");
+  return static_cast<int>(size);
+}
+
+// Appends a run of count primitives, extending the previous op if the run directly follows it in
+// both layouts.
+void AppendPrimitiveOp(PrimType prim_type, uint32_t count, uint32_t src_offset,
+                       uint32_t dest_offset, std::vector<impl::UnpackOp> *ops) {
+  using Kind = impl::UnpackOp::Kind;
+
+  // Primitives unpack to values of their packed size.
+  const uint32_t size = PrimPackedSize(prim_type);
+  if (!ops->empty()) {
+    impl::UnpackOp& prev = ops->back();
+    if (prev.kind == Kind::kPrimitive && prev.prim_type == prim_type &&
+        prev.src_offset + prev.count * size == src_offset &&
+        prev.dest_offset + prev.count * size == dest_offset) {
+      prev.count += count;
+      return;
+    }
+  }
+
+  ops->push_back({Kind::kPrimitive, prim_type, prim_type, 0, 0, src_offset, dest_offset, count, 0});
+}
+
+// Appends the ops of a field or array element of the given type.  Composite types reuse their own
+// (already compiled) plan, so compiling a plan costs the size of its children's plans rather than
+// a walk of the whole type tree below it.
+void AppendUnpackOps(const TypeDescriptor& type, uint32_t src_offset, uint32_t dest_offset,
+                     std::vector<impl::UnpackOp> *ops) {
+  if (type.IsPrimitive() || type.IsEnum()) {
+    AppendPrimitiveOp(type.prim_type(), 1, src_offset, dest_offset, ops);
+    return;
   }
 
+  for (const impl::UnpackOp& op : type.unpack_plan()) {
+    if (op.kind == impl::UnpackOp::Kind::kPrimitive) {
+      AppendPrimitiveOp(op.prim_type, op.count, src_offset + op.src_offset,
+                        dest_offset + op.dest_offset, ops);
+    } else {
+      ops->push_back(op);
+      ops->back().src_offset += src_offset;
+      ops->back().dest_offset += dest_offset;
+    }
+  }
+}
+
+// If every value of type is a single run of one primitive, sets *prim_type and *count to it.
+bool IsPrimitiveRun(const TypeDescriptor& type, PrimType *prim_type, uint32_t *count) {
+  if (type.IsPrimitive() || type.IsEnum()) {
+    *prim_type = type.prim_type();
+    *count = 1;
+    return true;
+  }
+
+  if (type.unpack_plan().size() != 1) return false;
+  const impl::UnpackOp& op = *type.unpack_plan().begin();
+  const uint32_t run_size = op.count * PrimPackedSize(op.prim_type);
+  if (op.kind != impl::UnpackOp::Kind::kPrimitive || op.src_offset != 0 || op.dest_offset != 0 ||
+      run_size != static_cast<uint32_t>(type.packed_size()) || run_size != type.value_size()) {
+    return false;
+  }
+
+  *prim_type = op.prim_type;
+  *count = op.count;
+  return true;
+}
+
+}  // namespace
+
+const TypeDescriptor& DescriptorBuilder::ParseStruct(std::string_view name, const YAML::Node& node,
+                                                     bool is_msg) {
+  std::vector<FieldDef> fields;
+
   // Iterate over "fields" array.
   for (const auto& field_node : node["fields"]) {
     // Iterate over field map.  Only one key should be without a leading _.  All else is metadata.
     for (const auto& field_def_pair : field_node) {
-      const std::string field_name = field_def_pair.first.as<std::string>();
+      std::string field_name = field_def_pair.first.as<std::string>();
 
       // Skip keys with leading _ as they are metadata.
       if (field_name.rfind("_", 0) == 0) continue;
@@ -35,137 +138,367 @@ const TypeDescriptor& DescriptorBuilder::ParseStruct(std::string_view name, cons
 
       if (field_type_node.IsScalar()) {
         // Field is simple type.
-        structure->AddField(field_name, *type_map_.at(field_type_node.as<std::string>()).get());
+        fields.push_back({std::move(field_name),
+                          type_map_.at(field_type_node.as<std::string>()), 0});
       } else if (field_type_node.IsSequence()) {
         // Field is array.
-        structure->AddField(field_name, ParseArray(field_type_node));
+        fields.push_back({std::move(field_name), &ParseArray(field_type_node), 0});
       } else {
         throw std::runtime_error("Unrecognized field description.");
       }
     }
   }
 
-  const TypeDescriptor& ret = *structure.get();
-  type_map_.emplace(name, std::move(structure));
-  return ret;
+  return AddStruct(name, fields, is_msg);
 }
 
 const TypeDescriptor& DescriptorBuilder::ParseArray(const YAML::Node& node) {
   const YAML::Node& type_node = node[0];  // Type is first element of sequence.
   const int size = node[1].as<int>();  // Size is second.
 
-  std::unique_ptr<TypeDescriptor> array;
-
   if (type_node.IsScalar()) {
     // Type is simple type.
-    array = std::unique_ptr<ArrayDescriptor>(
-        new ArrayDescriptor(*type_map_.at(type_node.as<std::string>()).get(), size));
+    return GetArray(*type_map_.at(type_node.as<std::string>()), size);
   } else if (type_node.IsSequence()) {
     // Type is nested array.
-    array = std::unique_ptr<ArrayDescriptor>(new ArrayDescriptor(ParseArray(type_node), size));
-  } else {
-    throw std::runtime_error("Unrecognized array description.");
+    return GetArray(ParseArray(type_node), size);
   }
 
-  // Array is not already in type_map.
-  if (!type_map_.count(array->name())) {
-    TypeDescriptor *ret = array.get();
-    type_map_.emplace(array->name(), std::move(array));
-    return *ret;
-  }
-
-  return *type_map_.at(array->name()).get();
+  throw std::runtime_error("Unrecognized array description.");
 }
 
 const TypeDescriptor& DescriptorBuilder::ParseEnum(std::string_view name, const YAML::Node& node) {
-  std::unique_ptr<EnumDescriptor> enumerator(new EnumDescriptor(name));
+  std::vector<std::string> values;
 
   // Iterate over "values" array.
   for (const auto& value_node : node["values"]) {
     // Iterate over value map.  Only one key should be without a leading _.  All else is metadata.
     for (const auto& value_def_pair : value_node) {
-      const std::string value_name = value_def_pair.first.as<std::string>();
+      std::string value_name = value_def_pair.first.as<std::string>();
 
       // Ignore metadata keys.
       if (value_name.rfind('_', 0) == 0) continue;
 
-      enumerator->AddValue(value_name);
+      values.push_back(std::move(value_name));
     }
   }
 
-  const TypeDescriptor& ret = *enumerator.get();
-  type_map_.emplace(name, std::move(enumerator));
-  return ret;
+  return AddEnum(name, values);
 }
 
 const TypeDescriptor& DescriptorBuilder::ParseBitfield(std::string_view name,
                                                        const YAML::Node& node) {
-  std::unique_ptr<BitfieldDescriptor> structure(new BitfieldDescriptor(name));
+  std::vector<FieldDef> fields;
 
   // Iterate over "fields" array.
   for (const auto& field_node : node["fields"]) {
     // Iterate over field map.  Only one key should be without a leading _.  All else is metadata.
     for (const auto& field_def_pair : field_node) {
-      const std::string field_name = field_def_pair.first.as<std::string>();
+      std::string field_name = field_def_pair.first.as<std::string>();
 
       // Skip keys with leading _ as they are metadata.
       if (field_name.rfind("_", 0) == 0) continue;
 
       const int size = field_def_pair.second.as<int>();
+      fields.push_back({std::move(field_name), &GetBitfieldFieldType(size), size});
+    }
+  }
 
-      const TypeDescriptor *prim;
-      if (size <= 8) {
-        prim = type_map_.at("uint8").get();
-      } else if (size <= 16) {
-        prim = type_map_.at("uint16").get();
-      } else if (size <= 32) {
-        prim = type_map_.at("uint32").get();
-      } else if (size <= 64) {
-        prim = type_map_.at("uint64").get();
-      } else {
-        throw std::runtime_error("Bitfield field too large.");
+  return AddBitfield(name, fields);
+}
+
+TypeDescriptor& DescriptorBuilder::NewType(std::string_view name, Type type) {
+  TypeDescriptor *ret = arena_->Allocate<TypeDescriptor>();
+  return *new (ret) TypeDescriptor(arena_->CopyString(name), type);
+}
+
+const TypeDescriptor& DescriptorBuilder::AddPrimitive(std::string_view name, PrimType prim_type) {
+  TypeDescriptor& primitive = NewType(name, Type::kPrimitive);
+  primitive.prim_type_ = prim_type;
+  primitive.packed_size_ = PrimPackedSize(prim_type);
+  primitive.value_size_ = primitive.packed_size_;
+  primitive.value_align_ = primitive.packed_size_;
+  primitive.uid_ = uid_hash::Primitive(name, primitive.packed_size_);
+
+  return AddNamedType(primitive);
+}
+
+const TypeDescriptor& DescriptorBuilder::AddEnum(std::string_view name,
+                                                 const std::vector<std::string>& values) {
+  TypeDescriptor& enumerator = NewType(name, Type::kEnum);
+
+  if (values.size() <= (1ULL << 7) - 1) {
+    enumerator.prim_type_ = PrimType::kInt8;
+  } else if (values.size() <= (1ULL << 15) - 1) {
+    enumerator.prim_type_ = PrimType::kInt16;
+  } else if (values.size() <= (1ULL << 31) - 1) {
+    enumerator.prim_type_ = PrimType::kInt32;
+  } else if (values.size() <= (1ULL << 63) - 1) {
+    enumerator.prim_type_ = PrimType::kInt64;
+  } else {
+    throw std::runtime_error("Too many enum values.");
+  }
+  enumerator.packed_size_ = PrimPackedSize(enumerator.prim_type_);
+  enumerator.value_size_ = enumerator.packed_size_;
+  enumerator.value_align_ = enumerator.packed_size_;
+
+  uid_hash::UidHasher hasher;
+  hasher.Append(name);
+  for (size_t i = 0; i < values.size(); ++i) {
+    hasher.AppendItem(uid_hash::EnumValue(values[i], i));
+  }
+
+  enumerator.enum_values_ = &arena_->CopyStrings(values);
+  enumerator.uid_ = hasher.Finalize();
+
+  return AddNamedType(enumerator);
+}
+
+const TypeDescriptor& DescriptorBuilder::AddStruct(std::string_view name,
+                                                   const std::vector<FieldDef>& fields,
+                                                   bool is_msg) {
+  TypeDescriptor& structure = NewType(name, Type::kStruct);
+  structure.is_message_ = is_msg;
+
+  // Add implicit SsHeader struct to messages.
+  const size_t num_fields = fields.size() + (is_msg ? 1 : 0);
+  FieldDescriptor *field_array = arena_->Allocate<FieldDescriptor>(num_fields);
+
+  uid_hash::UidHasher hasher;
+  hasher.Append(name);
+
+  int offset = 0;
+  uint32_t value_offset = 0;
+  size_t i = 0;
+  auto emplace = [&](std::string_view field_name, const TypeDescriptor& field_type) {
+    const uint32_t uid = uid_hash::StructField(field_name, field_type.uid());
+    FieldDescriptor *field = new (&field_array[i])
+        FieldDescriptor(arena_->CopyString(field_name), field_type, uid, i);
+    field->offset_ = offset;
+    field->value_offset_ = AlignUp(value_offset, field_type.value_align());
+
+    offset = CheckedSize(static_cast<uint64_t>(offset) + field_type.packed_size());
+    value_offset =
+        CheckedSize(static_cast<uint64_t>(field->value_offset_) + field_type.value_size());
+    structure.value_align_ = std::max(structure.value_align_, field_type.value_align());
+    hasher.AppendItem(uid);
+    ++i;
+  };
+
+  if (is_msg) emplace("ss_header", *type_map_.at("SsHeader"));
+  for (const FieldDef& field : fields) {
+    emplace(field.name, *field.type);
+  }
+
+  structure.fields_ = &arena_->NewFieldList(field_array, num_fields);
+  structure.packed_size_ = offset;
+  structure.value_size_ = AlignUp(value_offset, structure.value_align_);
+  structure.field_index_.Build(*arena_, field_array, num_fields);
+  structure.uid_ = hasher.Finalize();
+  CompileUnpackPlan(structure);
+
+  return AddNamedType(structure);
+}
+
+const TypeDescriptor& DescriptorBuilder::AddBitfield(std::string_view name,
+                                                     const std::vector<FieldDef>& fields) {
+  TypeDescriptor& bitfield = NewType(name, Type::kBitfield);
+
+  FieldDescriptor *field_array = arena_->Allocate<FieldDescriptor>(fields.size());
+
+  uid_hash::UidHasher hasher;
+  hasher.Append(name);
+
+  int bit_offset = 0;
+  uint32_t value_offset = 0;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const FieldDef& def = fields[i];
+    const uint32_t uid = uid_hash::BitfieldField(def.name, def.bit_size);
+    FieldDescriptor *field = new (&field_array[i])
+        FieldDescriptor(arena_->CopyString(def.name), *def.type, uid, i);
+    field->offset_ = bit_offset;
+    field->value_offset_ = AlignUp(value_offset, def.type->value_align());
+    field->bit_size_ = def.bit_size;
+    field->is_bitfield_field_ = true;
+
+    bit_offset += def.bit_size;
+    value_offset = field->value_offset_ + def.type->value_size();
+    bitfield.value_align_ = std::max(bitfield.value_align_, def.type->value_align());
+    hasher.AppendItem(uid);
+  }
+
+  if (bit_offset <= 8) {
+    bitfield.prim_type_ = PrimType::kUint8;
+  } else if (bit_offset <= 16) {
+    bitfield.prim_type_ = PrimType::kUint16;
+  } else if (bit_offset <= 32) {
+    bitfield.prim_type_ = PrimType::kUint32;
+  } else if (bit_offset <= 64) {
+    bitfield.prim_type_ = PrimType::kUint64;
+  } else {
+    throw std::runtime_error("Bitfield too big.");
+  }
+
+  bitfield.packed_size_ = PrimPackedSize(bitfield.prim_type_);
+  bitfield.value_size_ = AlignUp(value_offset, bitfield.value_align_);
+  bitfield.fields_ = &arena_->NewFieldList(field_array, fields.size());
+  bitfield.field_index_.Build(*arena_, field_array, fields.size());
+  bitfield.uid_ = hasher.Finalize();
+  CompileUnpackPlan(bitfield);
+
+  return AddNamedType(bitfield);
+}
+
+void DescriptorBuilder::CompileUnpackPlan(TypeDescriptor& type) {
+  if (defer_plans_) {
+    deferred_plans_.push_back(&type);
+    return;
+  }
+
+  // Checked as the plan grows, so one over the limit fails before it gets any bigger.
+  std::vector<impl::UnpackOp> ops;
+  const size_t max_ops = max_plan_ops_ - num_plan_ops_;
+  auto check_size = [&ops, max_ops] {
+    if (ops.size() > max_ops) throw std::runtime_error("Unpack plan too large.");
+  };
+
+  switch (type.type()) {
+    case Type::kBitfield: {
+      uint32_t remaining = type.struct_fields().size();
+      for (const FieldDescriptor *field : type.struct_fields()) {
+        ops.push_back({impl::UnpackOp::Kind::kBitfield, field->type().prim_type(),
+                       type.prim_type(), static_cast<uint8_t>(field->bit_offset()),
+                       static_cast<uint8_t>(field->bit_size()), 0, field->value_offset(),
+                       remaining--, BitfieldMask(field->bit_offset(), field->bit_size())});
+      }
+      check_size();
+      break;
+    }
+    case Type::kStruct:
+      for (const FieldDescriptor *field : type.struct_fields()) {
+        AppendUnpackOps(field->type(), field->offset(), field->value_offset(), &ops);
+        check_size();
+      }
+      break;
+    case Type::kArray: {
+      const TypeDescriptor& elem = type.array_elem_type();
+
+      // An array of primitive runs is a single run, however long.
+      PrimType prim_type;
+      uint32_t count;
+      if (type.array_size() > 0 && IsPrimitiveRun(elem, &prim_type, &count)) {
+        AppendPrimitiveOp(prim_type, count * type.array_size(), 0, 0, &ops);
+        break;
       }
 
-      structure->AddField(field_name, *prim, size);
+      for (int i = 0; i < type.array_size(); ++i) {
+        AppendUnpackOps(elem, i * elem.packed_size(), i * elem.value_size(), &ops);
+        check_size();
+      }
+      break;
     }
+    case Type::kPrimitive:
+    case Type::kEnum:
+      throw std::runtime_error("Type has no unpack_plan.");
   }
+  num_plan_ops_ += ops.size();
+
+  impl::UnpackOp *op_array = arena_->Allocate<impl::UnpackOp>(ops.size());
+  std::copy(ops.begin(), ops.end(), op_array);
+
+  impl::UnpackPlan *plan = arena_->Allocate<impl::UnpackPlan>();
+  type.unpack_plan_ = new (plan) impl::UnpackPlan(op_array, ops.size());
+}
 
-  const TypeDescriptor& ret = *structure.get();
-  type_map_.emplace(name, std::move(structure));
-  return ret;
+void DescriptorBuilder::CompileDeferredPlans() {
+  defer_plans_ = false;
+
+  // Types were added (and so deferred) after the types they contain.
+  for (TypeDescriptor *type : deferred_plans_) {
+    CompileUnpackPlan(*type);
+  }
+  deferred_plans_.clear();
 }
 
-DescriptorBuilder::DescriptorBuilder(const YAML::Node& root_node) {
+void DescriptorBuilder::BuildUidLookup() {
+  messages_.clear();
+  message_uids_.clear();
+  for (const TypeDescriptor *type : named_types_) {
+    if (type->type() != TypeDescriptor::Type::kStruct || !type->struct_is_message()) continue;
+    messages_.push_back(type);
+    message_uids_.push_back(type->uid());
+  }
+
+  uid_table_ = perfect_hash::Find(message_uids_);
+
+  messages_.push_back(nullptr);
+  message_uids_.push_back(0);
+}
+
+const TypeDescriptor& DescriptorBuilder::AddNamedType(const TypeDescriptor& type) {
+  type_map_.emplace(type.name(), &type);
+  type_index_.emplace(type.name(), &type);
+  named_types_.push_back(&type);
+  return type;
+}
+
+const TypeDescriptor& DescriptorBuilder::GetArray(const TypeDescriptor& elem, int size) {
+  const std::string name = std::string(elem.name()) + "[" + std::to_string(size) + "]";
+
+  // Array is already in type_map.
+  const auto& type_it = type_map_.find(name);
+  if (type_it != type_map_.end()) return *type_it->second;
+
+  TypeDescriptor& array = NewType(name, Type::kArray);
+  array.array_elem_ = &elem;
+  array.array_size_ = size;
+  array.packed_size_ = CheckedSize(static_cast<uint64_t>(elem.packed_size()) * size);
+  array.value_size_ = CheckedSize(static_cast<uint64_t>(elem.value_size()) * size);
+  array.value_align_ = elem.value_align();
+  array.uid_ = uid_hash::Array(elem.uid(), size);
+  CompileUnpackPlan(array);
+
+  type_map_.emplace(array.name(), &array);
+  type_index_.emplace(array.name(), &array);
+  return array;
+}
+
+const TypeDescriptor& DescriptorBuilder::GetBitfieldFieldType(int bit_size) const {
+  if (bit_size <= 8) {
+    return *type_map_.at("uint8");
+  } else if (bit_size <= 16) {
+    return *type_map_.at("uint16");
+  } else if (bit_size <= 32) {
+    return *type_map_.at("uint32");
+  } else if (bit_size <= 64) {
+    return *type_map_.at("uint64");
+  }
+
+  throw std::runtime_error("Bitfield field too large.");
+}
+
+DescriptorBuilder::DescriptorBuilder(size_t arena_size)
+    : arena_{std::make_unique<impl::DescriptorArena>(arena_size)} {
   // Add base types.
-  type_map_.emplace("uint8", std::unique_ptr<PrimitiveDescriptor>(
-                                 new PrimitiveDescriptor("uint8", PrimType::kUint8)));
-  type_map_.emplace("uint16", std::unique_ptr<PrimitiveDescriptor>(
-                                  new PrimitiveDescriptor("uint16", PrimType::kUint16)));
-  type_map_.emplace("uint32", std::unique_ptr<PrimitiveDescriptor>(
-                                  new PrimitiveDescriptor("uint32", PrimType::kUint32)));
-  type_map_.emplace("uint64", std::unique_ptr<PrimitiveDescriptor>(
-                                  new PrimitiveDescriptor("uint64", PrimType::kUint64)));
-  type_map_.emplace("int8", std::unique_ptr<PrimitiveDescriptor>(
-                                new PrimitiveDescriptor("int8", PrimType::kInt8)));
-  type_map_.emplace("int16", std::unique_ptr<PrimitiveDescriptor>(
-                                 new PrimitiveDescriptor("int16", PrimType::kInt16)));
-  type_map_.emplace("int32", std::unique_ptr<PrimitiveDescriptor>(
-                                 new PrimitiveDescriptor("int32", PrimType::kInt32)));
-  type_map_.emplace("int64", std::unique_ptr<PrimitiveDescriptor>(
-                                 new PrimitiveDescriptor("int64", PrimType::kInt64)));
-  type_map_.emplace("bool", std::unique_ptr<PrimitiveDescriptor>(
-                                new PrimitiveDescriptor("bool", PrimType::kBool)));
-  type_map_.emplace("float", std::unique_ptr<PrimitiveDescriptor>(
-                                 new PrimitiveDescriptor("float", PrimType::kFloat)));
-  type_map_.emplace("double", std::unique_ptr<PrimitiveDescriptor>(
-                                  new PrimitiveDescriptor("double", PrimType::kDouble)));
+  AddPrimitive("uint8", PrimType::kUint8);
+  AddPrimitive("uint16", PrimType::kUint16);
+  AddPrimitive("uint32", PrimType::kUint32);
+  AddPrimitive("uint64", PrimType::kUint64);
+  AddPrimitive("int8", PrimType::kInt8);
+  AddPrimitive("int16", PrimType::kInt16);
+  AddPrimitive("int32", PrimType::kInt32);
+  AddPrimitive("int64", PrimType::kInt64);
+  AddPrimitive("bool", PrimType::kBool);
+  AddPrimitive("float", PrimType::kFloat);
+  AddPrimitive("double", PrimType::kDouble);
 
   // Add implicit SsHeader.
-  std::unique_ptr<StructDescriptor> ss_header(new StructDescriptor("SsHeader", false));
-  ss_header->AddField("uid", *type_map_.at("uint32").get());
-  ss_header->AddField("len", *type_map_.at("uint16").get());
-  type_map_.emplace("SsHeader", std::move(ss_header));
+  AddStruct("SsHeader",
+            {{"uid", type_map_.at("uint32"), 0}, {"len", type_map_.at("uint16"), 0}},
+            false);
+}
 
+DescriptorBuilder::DescriptorBuilder(const YAML::Node& root_node) : DescriptorBuilder() {
   // Iterate through top level type definitions.
   for (const auto& pair : root_node) {
     const std::string name = pair.first.as<std::string>();
@@ -179,8 +512,7 @@ DescriptorBuilder::DescriptorBuilder(const YAML::Node& root_node) {
     if (type_name == "Struct") {
       (void)ParseStruct(name, type_node, false);
     } else if (type_name == "Message") {
-      const TypeDescriptor& msg = ParseStruct(name, type_node, true);
-      uid_lookup_.emplace(msg.uid(), &msg);
+      (void)ParseStruct(name, type_node, true);
     } else if (type_name == "Enum") {
       (void)ParseEnum(name, type_node);
     } else if (type_name == "Bitfield") {
@@ -189,6 +521,8 @@ DescriptorBuilder::DescriptorBuilder(const YAML::Node& root_node) {
       throw std::runtime_error("Unknown type name.");
     }
   }
+
+  BuildUidLookup();
 }
 
 DescriptorBuilder DescriptorBuilder::FromFile(const std::string& filename) {
@@ -199,5 +533,331 @@ DescriptorBuilder DescriptorBuilder::FromString(const std::string& str) {
   return DescriptorBuilder(YAML::Load(str));
 }
 
+// Descriptor blob format.  All integers are big endian, strings are a uint16 length followed by
+// the (unterminated) characters.
+//
+//   Header:
+//     char[4]  magic "SSDB"
+//     uint16   version
+//     uint16   reserved (0)
+//     uint32   number of type records
+//     uint32   total blob length, including header and trailer
+//   Type records, in definition order:
+//     uint8    kind (BlobKind)
+//     string   name
+//     uint32   uid
+//     uint32   packed size
+//     Enum:
+//       uint32 number of values, then each value name as a string
+//     Bitfield:
+//       uint32 number of fields, then for each: string name, uint8 bits
+//     Struct / Message (the implicit ss_header field is not stored):
+//       uint32 number of fields, then for each: string name, uint32 type reference,
+//       uint8 number of array dimensions, uint32 dimension sizes (outermost first)
+//   Trailer:
+//     uint32   CRC32 of everything before it
+//
+// Type references index the base types (in DescriptorBuilder() order, with SsHeader last) followed
+// by the type records.  Records only reference earlier types.  Python's descriptor_blob.py writes
+// the same format.
+
+namespace {
+
+constexpr char kBlobMagic[4] = {'S', 'S', 'D', 'B'};
+constexpr uint16_t kBlobVersion = 1;
+constexpr size_t kBlobHeaderSize = 16;
+constexpr size_t kBlobTrailerSize = 4;
+
+// Smallest encodings of a type record (kind, empty name, uid, packed size, count), an enum value
+// (empty name), a bitfield field (empty name, bit size) and a struct field (empty name, type
+// reference, no dimensions).
+constexpr size_t kBlobMinTypeSize = 1 + 2 + 4 + 4 + 4;
+constexpr size_t kBlobMinEnumValueSize = 2;
+constexpr size_t kBlobMinBitfieldFieldSize = 2 + 1;
+constexpr size_t kBlobMinStructFieldSize = 2 + 4 + 1;
+
+// Limits on what a blob may describe, whatever it claims.  A type's packed and unpacked sizes are
+// capped, as is the total size of the unpack plans built for it (which, for arrays of bitfields
+// or structs, grows with the array rather than with the blob).
+constexpr uint32_t kBlobMaxTypeSize = 1 << 28;
+constexpr size_t kBlobMaxPlanOps = 1 << 20;
+
+enum class BlobKind : uint8_t {
+  kEnum = 1,
+  kBitfield = 2,
+  kStruct = 3,
+  kMessage = 4,
+};
+
+class BlobWriter {
+ public:
+  template <typename T>
+  void Write(T value) {
+    const size_t pos = buf_.size();
+    buf_.resize(pos + sizeof(T));
+    PackBe<T>(value, buf_.data() + pos);
+  }
+
+  void WriteString(std::string_view str) {
+    if (str.size() > UINT16_MAX) throw std::runtime_error("Name too long for descriptor blob.");
+    Write<uint16_t>(str.size());
+    buf_.insert(buf_.end(), str.begin(), str.end());
+  }
+
+  std::vector<uint8_t>& buf() { return buf_; }
+
+ private:
+  std::vector<uint8_t> buf_;
+};
+
+class BlobReader {
+ public:
+  BlobReader(const uint8_t *data, size_t len) : data_{data}, len_{len} {}
+
+  template <typename T>
+  T Read() {
+    Require(sizeof(T));
+    const T value = UnpackBe<T>(data_ + pos_);
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  std::string_view ReadString() {
+    const uint16_t len = Read<uint16_t>();
+    Require(len);
+    const std::string_view str(reinterpret_cast<const char *>(data_ + pos_), len);
+    pos_ += len;
+    return str;
+  }
+
+  // Reads the number of records that follow, each at least record_size bytes, rejecting a count
+  // the rest of the blob can not hold before anything is allocated for it.
+  uint32_t ReadCount(size_t record_size) {
+    const uint32_t count = Read<uint32_t>();
+    if (count > remaining() / record_size) throw std::runtime_error("Descriptor blob truncated.");
+    return count;
+  }
+
+  size_t pos() const { return pos_; }
+  size_t remaining() const { return len_ - pos_; }
+
+ private:
+  void Require(size_t len) const {
+    if (len > len_ - pos_) throw std::runtime_error("Descriptor blob truncated.");
+  }
+
+  const uint8_t *data_;
+  size_t len_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+std::vector<uint8_t> DescriptorBuilder::ToBlob() const {
+  std::unordered_map<const TypeDescriptor *, uint32_t> type_refs;
+  for (size_t i = 0; i < named_types_.size(); ++i) {
+    type_refs.emplace(named_types_[i], i);
+  }
+
+  const size_t num_base_types = type_refs.at(type_map_.at("SsHeader")) + 1;
+
+  BlobWriter writer;
+  for (char c : kBlobMagic) writer.Write<char>(c);
+  writer.Write<uint16_t>(kBlobVersion);
+  writer.Write<uint16_t>(0);
+  writer.Write<uint32_t>(named_types_.size() - num_base_types);
+  writer.Write<uint32_t>(0);  // Total length, filled in below.
+
+  for (size_t i = num_base_types; i < named_types_.size(); ++i) {
+    const TypeDescriptor& type = *named_types_[i];
+
+    BlobKind kind;
+    switch (type.type()) {
+      case Type::kEnum:
+        kind = BlobKind::kEnum;
+        break;
+      case Type::kBitfield:
+        kind = BlobKind::kBitfield;
+        break;
+      case Type::kStruct:
+        kind = type.struct_is_message() ? BlobKind::kMessage : BlobKind::kStruct;
+        break;
+      default:
+        throw std::runtime_error("Unexpected named type.");
+    }
+
+    writer.Write<uint8_t>(static_cast<uint8_t>(kind));
+    writer.WriteString(type.name());
+    writer.Write<uint32_t>(type.uid());
+    writer.Write<uint32_t>(type.packed_size());
+
+    if (kind == BlobKind::kEnum) {
+      writer.Write<uint32_t>(type.enum_values().size());
+      for (std::string_view value : type.enum_values()) {
+        writer.WriteString(value);
+      }
+    } else if (kind == BlobKind::kBitfield) {
+      writer.Write<uint32_t>(type.struct_fields().size());
+      for (const auto& field : type.struct_fields()) {
+        writer.WriteString(field->name());
+        writer.Write<uint8_t>(field->bit_size());
+      }
+    } else {
+      const TypeDescriptor::FieldList& fields = type.struct_fields();
+      const size_t first_field = kind == BlobKind::kMessage ? 1 : 0;
+
+      writer.Write<uint32_t>(fields.size() - first_field);
+      for (size_t j = first_field; j < fields.size(); ++j) {
+        std::vector<uint32_t> dims;
+        const TypeDescriptor *base = &fields[j]->type();
+        while (base->IsArray()) {
+          dims.push_back(base->array_size());
+          base = &base->array_elem_type();
+        }
+
+        writer.WriteString(fields[j]->name());
+        writer.Write<uint32_t>(type_refs.at(base));
+        writer.Write<uint8_t>(dims.size());
+        for (uint32_t dim : dims) {
+          writer.Write<uint32_t>(dim);
+        }
+      }
+    }
+  }
+
+  std::vector<uint8_t>& buf = writer.buf();
+  PackBe<uint32_t>(buf.size() + kBlobTrailerSize, buf.data() + 12);
+  writer.Write<uint32_t>(GetCrc32(buf.data(), buf.size()));
+
+  return std::move(buf);
+}
+
+DescriptorBuilder DescriptorBuilder::FromBlob(const void *data, size_t len) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+  if (len < kBlobHeaderSize + kBlobTrailerSize) {
+    throw std::runtime_error("Descriptor blob truncated.");
+  }
+  if (memcmp(bytes, kBlobMagic, sizeof(kBlobMagic)) != 0) {
+    throw std::runtime_error("Not a descriptor blob.");
+  }
+
+  BlobReader header(bytes + sizeof(kBlobMagic), kBlobHeaderSize - sizeof(kBlobMagic));
+  if (header.Read<uint16_t>() != kBlobVersion) {
+    throw std::runtime_error("Unsupported descriptor blob version.");
+  }
+  (void)header.Read<uint16_t>();
+  const uint32_t num_types = header.Read<uint32_t>();
+  const uint32_t total_len = header.Read<uint32_t>();
+
+  // Allow trailing data (e.g. a log header followed by more content).
+  if (total_len > len || total_len < kBlobHeaderSize + kBlobTrailerSize) {
+    throw std::runtime_error("Descriptor blob truncated.");
+  }
+
+  const size_t crc_pos = total_len - kBlobTrailerSize;
+  if (GetCrc32(bytes, crc_pos) != UnpackBe<uint32_t>(bytes + crc_pos)) {
+    throw std::runtime_error("Descriptor blob CRC mismatch.");
+  }
+
+  BlobReader reader(bytes + kBlobHeaderSize, crc_pos - kBlobHeaderSize);
+  if (num_types > reader.remaining() / kBlobMinTypeSize) {
+    throw std::runtime_error("Descriptor blob truncated.");
+  }
+
+  // The blob is a good estimate of the arena needed, so the graph ends up in a single block.
+  DescriptorBuilder builder(std::max(kDefaultArenaSize / 4, 4 * static_cast<size_t>(total_len)));
+  builder.defer_plans_ = true;
+  builder.max_plan_ops_ = builder.num_plan_ops_ + kBlobMaxPlanOps;
+  std::vector<const TypeDescriptor *> type_refs = builder.named_types_;
+  type_refs.reserve(type_refs.size() + num_types);
+
+  auto lookup_ref = [&type_refs](uint32_t ref) -> const TypeDescriptor& {
+    if (ref >= type_refs.size()) {
+      throw std::runtime_error("Invalid descriptor blob type reference.");
+    }
+    return *type_refs[ref];
+  };
+
+  for (uint32_t i = 0; i < num_types; ++i) {
+    const BlobKind kind = static_cast<BlobKind>(reader.Read<uint8_t>());
+    const std::string_view name = reader.ReadString();
+    const uint32_t uid = reader.Read<uint32_t>();
+    const uint32_t packed_size = reader.Read<uint32_t>();
+
+    if (builder.type_index_.count(name)) {
+      throw std::runtime_error("Duplicate type in descriptor blob.");
+    }
+    if (packed_size > kBlobMaxTypeSize) {
+      throw std::runtime_error("Invalid descriptor blob type size.");
+    }
+
+    const TypeDescriptor *type;
+
+    if (kind == BlobKind::kEnum) {
+      std::vector<std::string> values(reader.ReadCount(kBlobMinEnumValueSize));
+      for (std::string& value : values) {
+        value = reader.ReadString();
+      }
+      type = &builder.AddEnum(name, values);
+    } else if (kind == BlobKind::kBitfield) {
+      std::vector<FieldDef> fields(reader.ReadCount(kBlobMinBitfieldFieldSize));
+      for (FieldDef& field : fields) {
+        field.name = reader.ReadString();
+        field.bit_size = reader.Read<uint8_t>();
+        field.type = &builder.GetBitfieldFieldType(field.bit_size);
+      }
+      type = &builder.AddBitfield(name, fields);
+    } else if (kind == BlobKind::kStruct || kind == BlobKind::kMessage) {
+      std::vector<FieldDef> fields(reader.ReadCount(kBlobMinStructFieldSize));
+      for (FieldDef& field : fields) {
+        field.name = reader.ReadString();
+        const TypeDescriptor& base = lookup_ref(reader.Read<uint32_t>());
+        const int num_dims = reader.Read<uint8_t>();
+
+        // A field can not be larger than its struct, which bounds the array sizes whatever the
+        // dimensions claim.
+        std::vector<uint32_t> dims(num_dims);
+        uint64_t field_size = std::max(base.packed_size(), 1);
+        for (uint32_t& dim : dims) {
+          dim = reader.Read<uint32_t>();
+          field_size *= dim;
+          if (dim > INT_MAX || field_size > packed_size) {
+            throw std::runtime_error("Invalid descriptor blob array size.");
+          }
+        }
+
+        // Arrays are built from the innermost dimension out.
+        field.type = &base;
+        for (auto dim_it = dims.rbegin(); dim_it != dims.rend(); ++dim_it) {
+          field.type = &builder.GetArray(*field.type, *dim_it);
+        }
+        field.bit_size = 0;
+      }
+      type = &builder.AddStruct(name, fields, kind == BlobKind::kMessage);
+    } else {
+      throw std::runtime_error("Unknown descriptor blob type kind.");
+    }
+
+    if (type->uid() != uid || type->packed_size() != static_cast<int>(packed_size)) {
+      throw std::runtime_error("Descriptor blob type does not match its UID.");
+    }
+    if (type->value_size() > kBlobMaxTypeSize) {
+      throw std::runtime_error("Invalid descriptor blob type size.");
+    }
+
+    type_refs.push_back(type);
+  }
+
+  if (reader.pos() != crc_pos - kBlobHeaderSize) {
+    throw std::runtime_error("Descriptor blob has trailing bytes.");
+  }
+
+  // Only now that every type checks out are their unpack plans built.
+  builder.CompileDeferredPlans();
+  builder.BuildUidLookup();
+  return builder;
+}
+
 }  // namespace dynamic
 }  // namespace ss
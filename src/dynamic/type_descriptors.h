@@ -1,411 +1,462 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include <yaml-cpp/yaml.h>
 
+#include "src/dynamic/packing.h"
+#include "src/perfect_hash.h"
 #include "src/uid_hash.h"
 
 namespace ss {
 namespace dynamic {
 
-class FieldDescriptor;
+class TypeDescriptor;
 
-class TypeDescriptor {
- public:
-  friend class DescriptorBuilder;
+namespace impl {
+class UnpackPlan;
+}  // namespace impl
 
-  using FieldList = std::vector<std::unique_ptr<const FieldDescriptor>>;
+// Descriptors are plain (non-virtual) objects owned by the DescriptorBuilder's arena.  Accessors
+// that do not apply to a descriptor's kind still throw std::runtime_error, but are ordinary inline
+// branches rather than virtual calls.  FieldList and TypeMap hold non-owning DescriptorPtrs into
+// the arena, which releases every descriptor at once.
 
-  enum class Type {
-    kPrimitive,
-    kEnum,
-    kStruct,
-    kBitfield,
-    kArray,
-  };
+// Non-owning pointer to a descriptor in a DescriptorBuilder's arena.  Keeps the get(), -> and *
+// interface of the std::unique_ptr elements FieldList and TypeMap used to hold, and converts
+// implicitly to a plain pointer.
+template <typename T>
+class DescriptorPtr {
+ public:
+  using element_type = T;
 
-  enum class PrimType {
-    kUint8,
-    kUint16,
-    kUint32,
-    kUint64,
-    kInt8,
-    kInt16,
-    kInt32,
-    kInt64,
-    kBool,
-    kFloat,
-    kDouble,
-  };
+  DescriptorPtr() = default;
+  DescriptorPtr(T *ptr) : ptr_{ptr} {}
 
-  Type type() const { return type_; }
-  int packed_size() const { return packed_size_; }
-  const std::string& name() const { return name_; }
-  uint32_t uid() const { return uid_; }
+  T *get() const { return ptr_; }
+  T *operator->() const { return ptr_; }
+  T& operator*() const { return *ptr_; }
+  operator T *() const { return ptr_; }
 
-  bool IsPrimitive() const { return type_ == Type::kPrimitive; }
-  bool IsEnum() const { return type_ == Type::kEnum; }
-  bool IsStruct() const { return type_ == Type::kStruct; }
-  bool IsBitfield() const { return type_ == Type::kBitfield; }
-  bool IsArray() const { return type_ == Type::kArray; }
+ private:
+  T *ptr_ = nullptr;
+};
 
-  virtual PrimType prim_type() const { throw std::runtime_error("Type has no prim_type."); }
-  virtual int array_size() const { throw std::runtime_error("Type has no array_size."); }
+class FieldDescriptor {
+ public:
+  friend class DescriptorBuilder;
 
-  virtual const std::vector<std::string>& enum_values() const {
-    throw std::runtime_error("Type has no enum_values.");
-  }
+  const std::string& name() const { return *name_; }
+  const TypeDescriptor& type() const { return *type_; }
+  uint32_t uid() const { return uid_; }
 
-  virtual const TypeDescriptor& array_elem_type() const {
-    throw std::runtime_error("Type has no array_elem_type().");
-  }
+  // Dense index of this field within its parent's struct_fields().
+  int ordinal() const { return ordinal_; }
 
-  virtual const FieldList& struct_fields() const {
-    throw std::runtime_error("Type has no struct_fields.");
+  int offset() const {
+    if (is_bitfield_field_) throw std::runtime_error("Field does not have offset.");
+    return offset_;
   }
 
-  virtual bool struct_is_message() const {
-    throw std::runtime_error("Type has no struct_is_message.");
+  int bit_offset() const {
+    if (!is_bitfield_field_) throw std::runtime_error("Field does not have bit_offset.");
+    return offset_;
   }
 
-  virtual const FieldDescriptor *operator[](std::string_view field_name) const {
-    throw std::runtime_error("Type has no field lookup.");
+  int bit_size() const {
+    if (!is_bitfield_field_) throw std::runtime_error("Field does not have bit_size.");
+    return bit_size_;
   }
 
- protected:
-  TypeDescriptor(std::string_view name, Type type) : name_{name}, type_{type} {}
-  TypeDescriptor(const TypeDescriptor&) = delete;
-  TypeDescriptor& operator=(const TypeDescriptor&) = delete;
-
-  int packed_size_ = 0;
-  uint32_t uid_ = 0;
+  // Byte offset of the field's value within its parent's unpacked layout (see
+  // TypeDescriptor::value_size()).
+  uint32_t value_offset() const { return value_offset_; }
 
  private:
-  std::string name_;
-  Type type_;
+  FieldDescriptor(const std::string& name, const TypeDescriptor& type, uint32_t uid, int ordinal)
+      : type_{&type}, name_{&name}, uid_{uid}, ordinal_{ordinal} {}
+  FieldDescriptor(const FieldDescriptor&) = delete;
+  FieldDescriptor& operator=(const FieldDescriptor&) = delete;
+
+  const TypeDescriptor *type_;
+  const std::string *name_;
+  uint32_t uid_;
+  int ordinal_;
+  int offset_ = 0;  // Byte offset in a struct, bit offset in a bitfield.
+  uint32_t value_offset_ = 0;
+  uint8_t bit_size_ = 0;
+  bool is_bitfield_field_ = false;
 };
 
-class PrimitiveDescriptor : public TypeDescriptor {
- public:
-  friend class DescriptorBuilder;
+// A struct or bitfield's fields in order.  The FieldDescriptors themselves are contiguous in the
+// arena, which owns them.
+using FieldList = std::vector<DescriptorPtr<const FieldDescriptor>>;
 
-  PrimType prim_type() const override { return prim_type_; }
+namespace impl {
 
- protected:
-  PrimitiveDescriptor(std::string_view name, PrimType prim_type)
-      : TypeDescriptor(name, Type::kPrimitive) {
-    SetPrimType(prim_type);
-    SetUid();
-  };
+// Bump allocator owning every descriptor of a DescriptorBuilder.  Only trivially destructible
+// objects are placed in the buffer, so the whole graph is released at once with the arena.  The
+// strings and lists the API returns by reference are kept alongside in containers that never move
+// their elements.
+class DescriptorArena {
+ public:
+  explicit DescriptorArena(size_t initial_size) : resource_(initial_size) {}
 
-  // Used by subclasses (e.g. Enum).
-  PrimitiveDescriptor(std::string_view name, Type type, PrimType prim_type)
-      : TypeDescriptor(name, type) {
-    SetPrimType(prim_type);
-  };
+  template <typename T>
+  T *Allocate(size_t count = 1) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    return static_cast<T *>(resource_.allocate(count * sizeof(T), alignof(T)));
+  }
 
-  PrimitiveDescriptor(const PrimitiveDescriptor&) = delete;
-  PrimitiveDescriptor& operator=(const PrimitiveDescriptor&) = delete;
+  const std::string& CopyString(std::string_view str) { return strings_.emplace_back(str); }
 
-  void SetPrimType(PrimType prim_type) {
-    prim_type_ = prim_type;
-    SetPackedSize();
+  const std::vector<std::string>& CopyStrings(const std::vector<std::string>& strs) {
+    return string_lists_.emplace_back(strs);
   }
 
- private:
-  void SetUid() { uid_ = PrimitiveHash(name().c_str(), packed_size_); }
-
-  void SetPackedSize() {
-    switch (prim_type_) {
-      case PrimType::kUint8:
-      case PrimType::kInt8:
-      case PrimType::kBool:
-        packed_size_ = 1;
-        break;
-      case PrimType::kUint16:
-      case PrimType::kInt16:
-        packed_size_ = 2;
-        break;
-      case PrimType::kUint32:
-      case PrimType::kInt32:
-      case PrimType::kFloat:
-        packed_size_ = 4;
-        break;
-      case PrimType::kUint64:
-      case PrimType::kInt64:
-      case PrimType::kDouble:
-        packed_size_ = 8;
-        break;
+  // List of fields[0, num_fields).
+  const FieldList& NewFieldList(const FieldDescriptor *fields, size_t num_fields) {
+    FieldList& list = field_lists_.emplace_back();
+    list.reserve(num_fields);
+    for (size_t i = 0; i < num_fields; ++i) {
+      list.emplace_back(&fields[i]);
     }
+    return list;
   }
 
-  PrimType prim_type_;
+ private:
+  std::pmr::monotonic_buffer_resource resource_;
+  std::deque<std::string> strings_;
+  std::deque<std::vector<std::string>> string_lists_;
+  std::deque<FieldList> field_lists_;
 };
 
-class EnumDescriptor : public PrimitiveDescriptor {
+// Open addressed name -> field table, built once a struct or bitfield is finalized.  The slots live
+// in the arena and the keys are the fields' own names, so lookups never allocate.
+class FieldIndex {
  public:
-  friend class DescriptorBuilder;
-
-  const std::vector<std::string>& enum_values() const override { return values_; }
-
- protected:
-  EnumDescriptor(std::string_view name) : PrimitiveDescriptor(name, Type::kEnum, PrimType::kInt8) {}
-  EnumDescriptor(const EnumDescriptor&) = delete;
-  EnumDescriptor& operator=(const EnumDescriptor&) = delete;
-
-  void AddValue(std::string_view value) {
-    values_.emplace_back(value);
-
-    if (values_.size() <= (1ULL << 7) - 1) {
-      SetPrimType(PrimType::kInt8);
-    } else if (values_.size() <= (1ULL << 15) - 1) {
-      SetPrimType(PrimType::kInt16);
-    } else if (values_.size() <= (1ULL << 31) - 1) {
-      SetPrimType(PrimType::kInt32);
-    } else if (values_.size() <= (1ULL << 63) - 1) {
-      SetPrimType(PrimType::kInt64);
-    } else {
-      throw std::runtime_error("Too many enum values.");
+  void Build(DescriptorArena& arena, const FieldDescriptor *fields, size_t num_fields) {
+    size_t num_slots = 1;
+    while (num_slots < 2 * num_fields) num_slots <<= 1;
+
+    slots_ = arena.Allocate<const FieldDescriptor *>(num_slots);
+    std::fill(slots_, slots_ + num_slots, nullptr);
+    mask_ = num_slots - 1;
+
+    for (size_t i = 0; i < num_fields; ++i) {
+      size_t slot = std::hash<std::string_view>()(fields[i].name()) & mask_;
+      while (slots_[slot]) slot = (slot + 1) & mask_;
+      slots_[slot] = &fields[i];
     }
-    SetUid();
   }
 
- private:
-  void SetUid() {
-    std::vector<uint32_t> value_hashes(values_.size());
-    for (size_t i = 0; i < value_hashes.size(); ++i) {
-      value_hashes[i] = EnumValueHash(values_[i].c_str(), i);
+  const FieldDescriptor *Find(std::string_view field_name) const {
+    if (!slots_) return nullptr;
+
+    for (size_t slot = std::hash<std::string_view>()(field_name) & mask_; slots_[slot];
+         slot = (slot + 1) & mask_) {
+      if (slots_[slot]->name() == field_name) return slots_[slot];
     }
-    uid_ = EnumHash(name().c_str(), value_hashes.data(), value_hashes.size());
+    return nullptr;
   }
 
-  std::vector<std::string> values_;
-};
-
-class FieldDescriptor {
- public:
-  const std::string& name() const { return name_; }
-  const TypeDescriptor& type() const { return type_; }
-  uint32_t uid() const { return uid_; }
-
-  virtual int offset() const { throw std::runtime_error("Field does not have offset."); }
-  virtual int bit_offset() const { throw std::runtime_error("Field does not have bit_offset."); }
-  virtual int bit_size() const { throw std::runtime_error("Field does not have bit_size."); }
-
- protected:
-  FieldDescriptor(const std::string& name, const TypeDescriptor& type, uint32_t uid)
-      : name_{name}, type_{type}, uid_{uid} {}
-  FieldDescriptor(const FieldDescriptor&) = delete;
-  FieldDescriptor& operator=(const FieldDescriptor&) = delete;
-
  private:
-  std::string name_;
-  const TypeDescriptor& type_;
-  uint32_t uid_;
+  const FieldDescriptor **slots_ = nullptr;
+  size_t mask_ = 0;
 };
 
-class StructFieldDescriptor : public FieldDescriptor {
- public:
-  int offset() const override { return offset_; }
-
- protected:
-  friend class StructDescriptor;
+}  // namespace impl
 
-  StructFieldDescriptor(const std::string& name, const TypeDescriptor& type, int offset)
-      : FieldDescriptor(name, type, StructFieldHash(name.c_str(), type.uid())), offset_{offset} {}
-  StructFieldDescriptor(const StructFieldDescriptor&) = delete;
-  StructFieldDescriptor& operator=(const StructFieldDescriptor&) = delete;
+class TypeDescriptor {
+ public:
+  friend class DescriptorBuilder;
 
- private:
-  int offset_;
-};
+  using FieldList = dynamic::FieldList;
 
-class BitfieldFieldDescriptor : public FieldDescriptor {
- public:
-  int bit_offset() const override { return bit_offset_; }
-  int bit_size() const override { return bit_size_; }
-
- protected:
-  friend class BitfieldDescriptor;
-
-  BitfieldFieldDescriptor(const std::string& name, const TypeDescriptor& type, int bit_offset,
-                          int bit_size)
-      : FieldDescriptor(name, type, BitfieldFieldHash(name.c_str(), bit_size)),
-        bit_offset_{bit_offset},
-        bit_size_{bit_size} {
-    (void)bit_offset_;
-    (void)bit_size_;
-  }
-  BitfieldFieldDescriptor(const BitfieldFieldDescriptor&) = delete;
-  BitfieldFieldDescriptor& operator=(const BitfieldFieldDescriptor&) = delete;
+  enum class Type {
+    kPrimitive,
+    kEnum,
+    kStruct,
+    kBitfield,
+    kArray,
+  };
 
- private:
-  int bit_offset_;
-  int bit_size_;
-};
+  enum class PrimType {
+    kUint8,
+    kUint16,
+    kUint32,
+    kUint64,
+    kInt8,
+    kInt16,
+    kInt32,
+    kInt64,
+    kBool,
+    kFloat,
+    kDouble,
+  };
 
-class StructDescriptor : public TypeDescriptor {
- public:
-  friend class DescriptorBuilder;
+  Type type() const { return type_; }
+  int packed_size() const { return packed_size_; }
+  const std::string& name() const { return *name_; }
+  uint32_t uid() const { return uid_; }
 
-  const FieldList& struct_fields() const override { return fields_; }
-  bool struct_is_message() const override { return is_message_; }
+  bool IsPrimitive() const { return type_ == Type::kPrimitive; }
+  bool IsEnum() const { return type_ == Type::kEnum; }
+  bool IsStruct() const { return type_ == Type::kStruct; }
+  bool IsBitfield() const { return type_ == Type::kBitfield; }
+  bool IsArray() const { return type_ == Type::kArray; }
 
-  const FieldDescriptor *operator[](std::string_view field_name) const override {
-    for (auto& field : fields_) {
-      if (field->name() == field_name) return field.get();
+  PrimType prim_type() const {
+    if (type_ != Type::kPrimitive && type_ != Type::kEnum && type_ != Type::kBitfield) {
+      throw std::runtime_error("Type has no prim_type.");
     }
-    return nullptr;
+    return prim_type_;
   }
 
- protected:
-  StructDescriptor(std::string_view name, bool is_message)
-      : TypeDescriptor(name, Type::kStruct), is_message_{is_message} {}
-  StructDescriptor(const StructDescriptor&) = delete;
-  StructDescriptor& operator=(const StructDescriptor&) = delete;
-
-  void AddField(const std::string& name, const TypeDescriptor& field) {
-    fields_.emplace_back(new StructFieldDescriptor(name, field, packed_size_));
-    packed_size_ += field.packed_size();
-    SetUid();
+  int array_size() const {
+    if (type_ != Type::kArray) throw std::runtime_error("Type has no array_size.");
+    return array_size_;
   }
 
- private:
-  void SetUid() {
-    std::vector<uint32_t> field_uids(fields_.size());
-    for (size_t i = 0; i < fields_.size(); ++i) {
-      field_uids[i] = fields_[i]->uid();
-    }
-    uid_ = StructHash(name().c_str(), field_uids.data(), field_uids.size());
+  const std::vector<std::string>& enum_values() const {
+    if (type_ != Type::kEnum) throw std::runtime_error("Type has no enum_values.");
+    return *enum_values_;
   }
 
-  FieldList fields_;
-  bool is_message_;
-};
-
-class BitfieldDescriptor : public TypeDescriptor {
- public:
-  friend class DescriptorBuilder;
-
-  PrimType prim_type() const override { return prim_type_; }
-  const FieldList& struct_fields() const override { return fields_; }
+  const TypeDescriptor& array_elem_type() const {
+    if (type_ != Type::kArray) throw std::runtime_error("Type has no array_elem_type().");
+    return *array_elem_;
+  }
 
-  const FieldDescriptor *operator[](std::string_view field_name) const override {
-    for (auto& field : fields_) {
-      if (field->name() == field_name) return field.get();
+  const FieldList& struct_fields() const {
+    if (type_ != Type::kStruct && type_ != Type::kBitfield) {
+      throw std::runtime_error("Type has no struct_fields.");
     }
-    return nullptr;
+    return *fields_;
   }
 
- protected:
-  BitfieldDescriptor(std::string_view name) : TypeDescriptor(name, Type::kBitfield) {}
-  BitfieldDescriptor(const BitfieldDescriptor&) = delete;
-  BitfieldDescriptor& operator=(const BitfieldDescriptor&) = delete;
-
-  void AddField(const std::string& name, const TypeDescriptor& field, int bit_size) {
-    fields_.emplace_back(new BitfieldFieldDescriptor(name, field, cur_bit_offset_, bit_size));
-    cur_bit_offset_ += bit_size;
-    SetBitfieldSize();
-    SetUid();
+  bool struct_is_message() const {
+    if (type_ != Type::kStruct) throw std::runtime_error("Type has no struct_is_message.");
+    return is_message_;
   }
 
- private:
-  void SetUid() {
-    std::vector<uint32_t> field_uids(fields_.size());
-    for (size_t i = 0; i < fields_.size(); ++i) {
-      field_uids[i] = fields_[i]->uid();
+  const FieldDescriptor *operator[](std::string_view field_name) const {
+    if (type_ != Type::kStruct && type_ != Type::kBitfield) {
+      throw std::runtime_error("Type has no field lookup.");
     }
-    uid_ = BitfieldHash(name().c_str(), field_uids.data(), field_uids.size());
+    return field_index_.Find(field_name);
   }
 
-  void SetBitfieldSize() {
-    if (cur_bit_offset_ <= 8) {
-      prim_type_ = PrimType::kUint8;
-      packed_size_ = 1;
-    } else if (cur_bit_offset_ <= 16) {
-      prim_type_ = PrimType::kUint16;
-      packed_size_ = 2;
-    } else if (cur_bit_offset_ <= 32) {
-      prim_type_ = PrimType::kUint32;
-      packed_size_ = 4;
-    } else if (cur_bit_offset_ <= 64) {
-      prim_type_ = PrimType::kUint64;
-      packed_size_ = 8;
-    } else {
-      throw std::runtime_error("Bitfield too big.");
-    }
-  }
+  // Size and alignment of the type's unpacked layout: primitives in native representation at their
+  // natural alignment, struct (and bitfield) fields in order, array elements back to back, all
+  // nested inline.  DynamicStruct and DynamicArray store values in this layout.
+  uint32_t value_size() const { return value_size_; }
+  uint32_t value_align() const { return value_align_; }
+
+  // Precompiled decode program for struct, bitfield and array types.
+  const impl::UnpackPlan& unpack_plan() const;
+
+ private:
+  TypeDescriptor(const std::string& name, Type type) : type_{type}, name_{&name} {}
+  TypeDescriptor(const TypeDescriptor&) = delete;
+  TypeDescriptor& operator=(const TypeDescriptor&) = delete;
 
-  FieldList fields_;
+  // Members used while decoding come first so they share a cache line.
+  Type type_;
   PrimType prim_type_ = PrimType::kUint8;
-  int cur_bit_offset_ = 0;
+  bool is_message_ = false;
+  int packed_size_ = 0;
+  int array_size_ = 0;
+  uint32_t value_size_ = 0;
+  uint32_t value_align_ = 1;
+  const TypeDescriptor *array_elem_ = nullptr;
+  const FieldList *fields_ = nullptr;
+  const impl::UnpackPlan *unpack_plan_ = nullptr;
+  uint32_t uid_ = 0;
+  const std::vector<std::string> *enum_values_ = nullptr;
+  impl::FieldIndex field_index_;
+  const std::string *name_;
 };
 
-class ArrayDescriptor : public TypeDescriptor {
- public:
-  friend class DescriptorBuilder;
+namespace impl {
+
+template <typename T>
+constexpr TypeDescriptor::PrimType PrimTypeOf() {
+  using PrimType = TypeDescriptor::PrimType;
+
+  if constexpr (std::is_same_v<T, uint8_t>) {
+    return PrimType::kUint8;
+  } else if constexpr (std::is_same_v<T, uint16_t>) {
+    return PrimType::kUint16;
+  } else if constexpr (std::is_same_v<T, uint32_t>) {
+    return PrimType::kUint32;
+  } else if constexpr (std::is_same_v<T, uint64_t>) {
+    return PrimType::kUint64;
+  } else if constexpr (std::is_same_v<T, int8_t>) {
+    return PrimType::kInt8;
+  } else if constexpr (std::is_same_v<T, int16_t>) {
+    return PrimType::kInt16;
+  } else if constexpr (std::is_same_v<T, int32_t>) {
+    return PrimType::kInt32;
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return PrimType::kInt64;
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return PrimType::kBool;
+  } else if constexpr (std::is_same_v<T, float>) {
+    return PrimType::kFloat;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return PrimType::kDouble;
+  } else {
+    static_assert(always_false_v<T>);
+  }
+}
+
+// One step of an UnpackPlan.  A kPrimitive op decodes count consecutive primitives of prim_type
+// starting at src_offset into count consecutive values starting at dest_offset of the unpacked
+// layout.  A kBitfield op extracts the bit_size bits at bit_offset (mask, precomputed) of the
+// container of container_type at src_offset into the value at dest_offset.  The fields of a
+// bitfield are consecutive ops, and count is the number of ops left in that group (including this
+// one), so the container is read once for all of them.
+struct UnpackOp {
+  enum class Kind : uint8_t {
+    kPrimitive,
+    kBitfield,
+  };
 
-  int array_size() const override { return size_; }
-  const TypeDescriptor& array_elem_type() const override { return elem_; }
+  Kind kind;
+  TypeDescriptor::PrimType prim_type;
+  TypeDescriptor::PrimType container_type;
+  uint8_t bit_offset;
+  uint8_t bit_size;
+  uint32_t src_offset;
+  uint32_t dest_offset;
+  uint32_t count;
+  uint64_t mask;
+};
 
- protected:
-  ArrayDescriptor(const TypeDescriptor& elem, int size)
-      : TypeDescriptor(ArrayName(elem, size), Type::kArray), elem_{elem}, size_{size} {
-    packed_size_ = elem.packed_size() * size;
-    uid_ = ArrayHash(elem.uid(), size);
-  }
+// A type's decode flattened into a linear list of ops over its primitive leaves, depth first
+// (struct fields in order, array elements in order, bitfield fields in order).  Primitives of the
+// same kind that are adjacent in both the packed and unpacked layouts are merged into a single op.
+// Ops address the unpacked value by byte offset (FieldDescriptor::value_offset()), so running a
+// plan needs no per-value setup.  DynamicStruct::Pack runs the same plan with source and
+// destination swapped.
+class UnpackPlan {
+ public:
+  UnpackPlan(const UnpackOp *ops, size_t num_ops) : ops_{ops}, num_ops_{num_ops} {}
 
-  ArrayDescriptor(const ArrayDescriptor&) = delete;
-  ArrayDescriptor& operator=(const ArrayDescriptor&) = delete;
+  const UnpackOp *begin() const { return ops_; }
+  const UnpackOp *end() const { return ops_ + num_ops_; }
+  size_t size() const { return num_ops_; }
 
  private:
-  static std::string ArrayName(const TypeDescriptor& elem, int size) {
-    return elem.name() + "[" + std::to_string(size) + "]";
-  }
-
-  const TypeDescriptor& elem_;
-  int size_;
+  const UnpackOp *ops_;
+  size_t num_ops_;
 };
 
+}  // namespace impl
+
+inline const impl::UnpackPlan& TypeDescriptor::unpack_plan() const {
+  if (!unpack_plan_) throw std::runtime_error("Type has no unpack_plan.");
+  return *unpack_plan_;
+}
+
 class DescriptorBuilder {
  public:
-  using TypeMap = std::unordered_map<std::string, std::unique_ptr<const TypeDescriptor>>;
+  using TypeMap = std::unordered_map<std::string, DescriptorPtr<const TypeDescriptor>>;
 
   static DescriptorBuilder FromFile(const std::string& filename);
   static DescriptorBuilder FromString(const std::string& str);
 
+  // Load from the compact binary form produced by ToBlob() (or the generators' --log_header blob
+  // option).  Validates the blob and throws std::runtime_error if it is malformed.
+  static DescriptorBuilder FromBlob(const void *data, size_t len);
+
   DescriptorBuilder(const YAML::Node& root_node);
 
-  const TypeDescriptor *operator[](const std::string& name) const {
-    const auto& type_it = type_map_.find(name);
-    if (type_it == type_map_.end()) return nullptr;
-    return type_it->second.get();
+  // Serialize the resolved type graph.  See type_descriptors.cc for the format.
+  std::vector<uint8_t> ToBlob() const;
+
+  const TypeDescriptor *operator[](std::string_view name) const {
+    const auto& type_it = type_index_.find(name);
+    if (type_it == type_index_.end()) return nullptr;
+    return type_it->second;
   }
 
   const TypeMap& types() const { return type_map_; }
 
   const TypeDescriptor *LookupMsgFromUid(uint32_t msg_uid) const {
-    const auto& type_it = uid_lookup_.find(msg_uid);
-    if (type_it == uid_lookup_.end()) return nullptr;
-    return type_it->second;
+    const uint32_t i = uid_table_.Lookup(msg_uid);
+    return msg_uid == message_uids_[i] ? messages_[i] : nullptr;
   }
 
  private:
+  struct FieldDef {
+    std::string name;
+    const TypeDescriptor *type;
+    int bit_size;
+  };
+
+  // Only the base types and SsHeader.
+  explicit DescriptorBuilder(size_t arena_size = kDefaultArenaSize);
+
   const TypeDescriptor& ParseStruct(std::string_view name, const YAML::Node& node, bool is_msg);
   const TypeDescriptor& ParseArray(const YAML::Node& node);
   const TypeDescriptor& ParseEnum(std::string_view name, const YAML::Node& node);
   const TypeDescriptor& ParseBitfield(std::string_view name, const YAML::Node& node);
 
+  TypeDescriptor& NewType(std::string_view name, TypeDescriptor::Type type);
+  const TypeDescriptor& AddPrimitive(std::string_view name, TypeDescriptor::PrimType prim_type);
+  const TypeDescriptor& AddEnum(std::string_view name, const std::vector<std::string>& values);
+  const TypeDescriptor& AddStruct(std::string_view name, const std::vector<FieldDef>& fields,
+                                  bool is_msg);
+  const TypeDescriptor& AddBitfield(std::string_view name, const std::vector<FieldDef>& fields);
+  const TypeDescriptor& AddNamedType(const TypeDescriptor& type);
+  const TypeDescriptor& GetArray(const TypeDescriptor& elem, int size);
+  const TypeDescriptor& GetBitfieldFieldType(int bit_size) const;
+  void CompileUnpackPlan(TypeDescriptor& type);
+  void CompileDeferredPlans();
+  void BuildUidLookup();
+
+  static constexpr size_t kDefaultArenaSize = 64 * 1024;
+
  private:
+  // Held by pointer so descriptors stay put when the builder is moved.
+  std::unique_ptr<impl::DescriptorArena> arena_;
+
+  // Non-owning, like FieldList: every descriptor lives in arena_.
   TypeMap type_map_;
-  std::unordered_map<uint32_t, const TypeDescriptor *> uid_lookup_;
+
+  // type_map_ keyed on the descriptors' own names, so operator[] never allocates.
+  std::unordered_map<std::string_view, const TypeDescriptor *> type_index_;
+
+  // Messages in definition order followed by a nullptr / 0 entry that empty hash slots point at.
+  perfect_hash::Table uid_table_;
+  std::vector<const TypeDescriptor *> messages_{nullptr};
+  std::vector<uint32_t> message_uids_{0};
+
+  // Non-array types in definition order, base types first.
+  std::vector<const TypeDescriptor *> named_types_;
+
+  // While defer_plans_ is set, types are queued for CompileDeferredPlans() rather than compiled as
+  // they are added, so FromBlob() can validate a type before building anything for it.
+  bool defer_plans_ = false;
+  std::vector<TypeDescriptor *> deferred_plans_;
+
+  // Ops across every unpack plan of the builder, and the most allowed.
+  size_t num_plan_ops_ = 0;
+  size_t max_plan_ops_ = SIZE_MAX;
 };
 
 }  // namespace dynamic
@@ -0,0 +1,71 @@
+#include "src/dynamic/visitor.h"
+
+#include <stdexcept>
+
+namespace ss {
+namespace dynamic {
+
+VisitPlan VisitPlan::Compile(const TypeDescriptor& type) {
+  if (!type.IsStruct() && !type.IsBitfield() && !type.IsArray()) {
+    throw std::runtime_error("VisitPlan requires a struct, bitfield or array type.");
+  }
+
+  VisitPlan plan(type);
+  plan.AddOps(type, nullptr, -1, 0, 0);
+  return plan;
+}
+
+void VisitPlan::AddOps(const TypeDescriptor& type, const FieldDescriptor *field, int index,
+                       int depth, uint32_t offset) {
+  using Kind = impl::VisitOp::Kind;
+  using PrimType = TypeDescriptor::PrimType;
+
+  const VisitNode node{&type, field, index, depth};
+  impl::VisitOp op{Kind::kValue, PrimType::kUint8, PrimType::kUint8, 0, offset, 0, node};
+
+  switch (type.type()) {
+    case TypeDescriptor::Type::kPrimitive:
+    case TypeDescriptor::Type::kEnum:
+      op.prim_type = type.prim_type();
+      ops_.push_back(op);
+      break;
+
+    case TypeDescriptor::Type::kStruct:
+      op.kind = Kind::kBeginStruct;
+      ops_.push_back(op);
+      for (const FieldDescriptor *child : type.struct_fields()) {
+        AddOps(child->type(), child, -1, depth + 1, offset + child->offset());
+      }
+      op.kind = Kind::kEndStruct;
+      ops_.push_back(op);
+      break;
+
+    case TypeDescriptor::Type::kBitfield:
+      op.kind = Kind::kBeginStruct;
+      ops_.push_back(op);
+      for (const FieldDescriptor *child : type.struct_fields()) {
+        ops_.push_back(impl::VisitOp{Kind::kBitfieldValue, child->type().prim_type(),
+                                     type.prim_type(), static_cast<uint8_t>(child->bit_offset()),
+                                     offset, BitfieldMask(child->bit_offset(), child->bit_size()),
+                                     VisitNode{&child->type(), child, -1, depth + 1}});
+      }
+      op.kind = Kind::kEndStruct;
+      ops_.push_back(op);
+      break;
+
+    case TypeDescriptor::Type::kArray: {
+      op.kind = Kind::kBeginArray;
+      ops_.push_back(op);
+      const TypeDescriptor& elem = type.array_elem_type();
+      for (int i = 0; i < type.array_size(); ++i) {
+        AddOps(elem, nullptr, i, depth + 1, offset + i * elem.packed_size());
+      }
+      op.kind = Kind::kEndArray;
+      ops_.push_back(op);
+      break;
+    }
+  }
+}
+
+}  // namespace dynamic
+}  // namespace ss
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "src/dynamic/packing.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+
+// Where a visited value sits: its type, the field it is the value of (nullptr for the root and for
+// array elements) and its index within the enclosing array (-1 outside of arrays).
+struct VisitNode {
+  const TypeDescriptor *type;
+  const FieldDescriptor *field;
+  int index;
+  // Nesting level, 0 for the root.
+  int depth;
+
+  std::string_view name() const { return field ? field->name() : std::string_view(); }
+};
+
+namespace impl {
+
+// One event of a VisitPlan.  kValue reads a primitive or enum of prim_type at offset.
+// kBitfieldValue extracts the bits under mask (at shift) of the container_type container at
+// offset.
+struct VisitOp {
+  enum class Kind : uint8_t {
+    kBeginStruct,
+    kEndStruct,
+    kBeginArray,
+    kEndArray,
+    kValue,
+    kBitfieldValue,
+  };
+
+  Kind kind;
+  TypeDescriptor::PrimType prim_type;
+  TypeDescriptor::PrimType container_type;
+  uint8_t shift;
+  uint32_t offset;
+  uint64_t mask;
+  VisitNode node;
+};
+
+}  // namespace impl
+
+// A type's traversal flattened into the list of events Visit() emits, depth first (struct and
+// bitfield fields in order, array elements in order).  Compile once per type and reuse.
+class VisitPlan {
+ public:
+  // Throws std::runtime_error if type is not a struct, bitfield or array.
+  static VisitPlan Compile(const TypeDescriptor& type);
+
+  const TypeDescriptor& type() const { return *type_; }
+
+  const impl::VisitOp *begin() const { return ops_.data(); }
+  const impl::VisitOp *end() const { return ops_.data() + ops_.size(); }
+  size_t size() const { return ops_.size(); }
+
+ private:
+  explicit VisitPlan(const TypeDescriptor& type) : type_{&type} {}
+
+  void AddOps(const TypeDescriptor& type, const FieldDescriptor *field, int index, int depth,
+              uint32_t offset);
+
+  const TypeDescriptor *type_;
+  std::vector<impl::VisitOp> ops_;
+};
+
+// Visitor with a no-op for every event.  Derive from it and define only the events of interest;
+// bring the remaining Value overloads into scope with "using NullVisitor::Value;" (or define Value
+// as a template) so no value is implicitly converted to another overload's type.
+struct NullVisitor {
+  void BeginStruct(const VisitNode&) {}
+  void EndStruct(const VisitNode&) {}
+  void BeginArray(const VisitNode&) {}
+  void EndArray(const VisitNode&) {}
+
+  void Value(const VisitNode&, uint8_t) {}
+  void Value(const VisitNode&, uint16_t) {}
+  void Value(const VisitNode&, uint32_t) {}
+  void Value(const VisitNode&, uint64_t) {}
+  void Value(const VisitNode&, int8_t) {}
+  void Value(const VisitNode&, int16_t) {}
+  void Value(const VisitNode&, int32_t) {}
+  void Value(const VisitNode&, int64_t) {}
+  void Value(const VisitNode&, bool) {}
+  void Value(const VisitNode&, float) {}
+  void Value(const VisitNode&, double) {}
+};
+
+namespace impl {
+
+template <typename T, typename Visitor>
+inline void VisitBits(const VisitOp& op, uint64_t bits, Visitor& visitor) {
+  visitor.Value(op.node, static_cast<T>(bits));
+}
+
+}  // namespace impl
+
+// Walks a packed value of plan.type(), calling visitor.BeginStruct / EndStruct (also for
+// bitfields), BeginArray / EndArray and Value(node, T) with T the value's exact primitive type
+// (an enum's underlying type, a bitfield field's unsigned type).  Values are read straight from
+// data; nothing is allocated and calls are resolved at compile time.
+template <typename Visitor>
+void Visit(const uint8_t *data, const VisitPlan& plan, Visitor& visitor) {
+  using Kind = impl::VisitOp::Kind;
+  using PrimType = TypeDescriptor::PrimType;
+
+  for (const impl::VisitOp& op : plan) {
+    const uint8_t *value = data + op.offset;
+
+    switch (op.kind) {
+      case Kind::kBeginStruct:
+        visitor.BeginStruct(op.node);
+        break;
+      case Kind::kEndStruct:
+        visitor.EndStruct(op.node);
+        break;
+      case Kind::kBeginArray:
+        visitor.BeginArray(op.node);
+        break;
+      case Kind::kEndArray:
+        visitor.EndArray(op.node);
+        break;
+
+      case Kind::kValue:
+        switch (op.prim_type) {
+          case PrimType::kUint8:
+            visitor.Value(op.node, UnpackBe<uint8_t>(value));
+            break;
+          case PrimType::kUint16:
+            visitor.Value(op.node, UnpackBe<uint16_t>(value));
+            break;
+          case PrimType::kUint32:
+            visitor.Value(op.node, UnpackBe<uint32_t>(value));
+            break;
+          case PrimType::kUint64:
+            visitor.Value(op.node, UnpackBe<uint64_t>(value));
+            break;
+          case PrimType::kInt8:
+            visitor.Value(op.node, UnpackBe<int8_t>(value));
+            break;
+          case PrimType::kInt16:
+            visitor.Value(op.node, UnpackBe<int16_t>(value));
+            break;
+          case PrimType::kInt32:
+            visitor.Value(op.node, UnpackBe<int32_t>(value));
+            break;
+          case PrimType::kInt64:
+            visitor.Value(op.node, UnpackBe<int64_t>(value));
+            break;
+          case PrimType::kBool:
+            visitor.Value(op.node, UnpackBe<bool>(value));
+            break;
+          case PrimType::kFloat:
+            visitor.Value(op.node, UnpackBe<float>(value));
+            break;
+          case PrimType::kDouble:
+            visitor.Value(op.node, UnpackBe<double>(value));
+            break;
+        }
+        break;
+
+      case Kind::kBitfieldValue: {
+        uint64_t raw = 0;
+        switch (op.container_type) {
+          case PrimType::kUint8:
+            raw = UnpackBe<uint8_t>(value);
+            break;
+          case PrimType::kUint16:
+            raw = UnpackBe<uint16_t>(value);
+            break;
+          case PrimType::kUint32:
+            raw = UnpackBe<uint32_t>(value);
+            break;
+          default:
+            raw = UnpackBe<uint64_t>(value);
+            break;
+        }
+
+        const uint64_t bits = ExtractBits(raw, op.mask, op.shift);
+        switch (op.prim_type) {
+          case PrimType::kUint8:
+            impl::VisitBits<uint8_t>(op, bits, visitor);
+            break;
+          case PrimType::kUint16:
+            impl::VisitBits<uint16_t>(op, bits, visitor);
+            break;
+          case PrimType::kUint32:
+            impl::VisitBits<uint32_t>(op, bits, visitor);
+            break;
+          default:
+            impl::VisitBits<uint64_t>(op, bits, visitor);
+            break;
+        }
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace dynamic
+}  // namespace ss
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+namespace ss {
+namespace perfect_hash {
+
+// Collision free hash tables over message UIDs, built by hash and displace.  A first hash picks a
+// bucket of about two UIDs, and that bucket's displacement is added to a second hash to index a
+// power of two table of positions into the UID list, at least as large as the list:
+//
+//   slot = (Slot(uid, mult, bits) + displacements[Slot(uid, bucket_mult, bucket_bits)]) & mask
+//
+// Buckets are placed largest first, each at the first displacement where all of its UIDs land in
+// empty slots, so the tables are O(n) in size.  Empty slots hold the list size, which callers
+// point at a trailing "unknown" entry, so a lookup is two multiplies, two loads and a compare
+// regardless of the number of messages.  src/perfect_hash.py runs the same search for the
+// generated libraries.
+
+constexpr int kMaxBits = 24;
+constexpr int kAttemptsPerBits = 100;
+
+constexpr uint32_t Multiplier(uint32_t attempt) {
+  uint32_t x = attempt * 0x9E3779B9u + 0x7F4A7C15u;
+  x ^= x >> 16;
+  x *= 0x85EBCA6Bu;
+  x ^= x >> 13;
+  return x | 1;
+}
+
+constexpr uint32_t Slot(uint32_t uid, uint32_t mult, int bits) {
+  return static_cast<uint32_t>(uid * mult) >> (32 - bits);
+}
+
+// Default constructed, the table for no UIDs.
+struct Table {
+  uint32_t Lookup(uint32_t uid) const {
+    const uint32_t displacement = displacements[Slot(uid, bucket_mult, bucket_bits)];
+    return slots[(Slot(uid, mult, bits) + displacement) & (slots.size() - 1)];
+  }
+
+  uint32_t bucket_mult = 1;
+  int bucket_bits = 1;
+  uint32_t mult = 1;
+  int bits = 1;
+  std::vector<uint32_t> displacements{0, 0};
+  std::vector<uint32_t> slots{0, 0};
+};
+
+namespace impl {
+
+// Places every bucket for one pair of multipliers, or returns false if some bucket fits at no
+// displacement.
+inline bool PlaceBuckets(const std::vector<uint32_t>& uids, Table& table) {
+  const uint32_t empty = uids.size();
+  const uint32_t num_slots = uint32_t{1} << table.bits;
+  const uint32_t mask = num_slots - 1;
+
+  std::vector<std::vector<uint32_t>> buckets(size_t{1} << table.bucket_bits);
+  for (size_t i = 0; i < uids.size(); ++i) {
+    buckets[Slot(uids[i], table.bucket_mult, table.bucket_bits)].push_back(i);
+  }
+
+  std::vector<uint32_t> order(buckets.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  table.displacements.assign(buckets.size(), 0);
+  table.slots.assign(num_slots, empty);
+
+  std::vector<uint32_t> positions;
+  for (uint32_t bucket : order) {
+    const std::vector<uint32_t>& members = buckets[bucket];
+    if (members.empty()) break;
+
+    bool placed = false;
+    for (uint32_t displacement = 0; displacement < num_slots && !placed; ++displacement) {
+      positions.clear();
+      placed = true;
+      for (uint32_t i : members) {
+        const uint32_t slot = (Slot(uids[i], table.mult, table.bits) + displacement) & mask;
+        if (table.slots[slot] != empty ||
+            std::find(positions.begin(), positions.end(), slot) != positions.end()) {
+          placed = false;
+          break;
+        }
+        positions.push_back(slot);
+      }
+
+      if (placed) {
+        table.displacements[bucket] = displacement;
+        for (size_t j = 0; j < members.size(); ++j) table.slots[positions[j]] = members[j];
+      }
+    }
+
+    if (!placed) return false;
+  }
+
+  return true;
+}
+
+}  // namespace impl
+
+inline Table Find(const std::vector<uint32_t>& uids) {
+  if (std::unordered_set<uint32_t>(uids.begin(), uids.end()).size() != uids.size()) {
+    throw std::runtime_error("Duplicate UIDs cannot be perfectly hashed.");
+  }
+
+  if (uids.empty()) return Table();
+
+  // At least one slot per UID and one bucket per two UIDs.
+  int bits = 1;
+  while ((size_t{1} << bits) < uids.size()) ++bits;
+  int bucket_bits = 1;
+  while ((size_t{2} << bucket_bits) < uids.size()) ++bucket_bits;
+
+  Table table;
+  for (; bits <= kMaxBits; ++bits, ++bucket_bits) {
+    for (int attempt = 0; attempt < kAttemptsPerBits; ++attempt) {
+      table.bucket_mult = Multiplier(2 * attempt);
+      table.bucket_bits = bucket_bits;
+      table.mult = Multiplier(2 * attempt + 1);
+      table.bits = bits;
+
+      if (impl::PlaceBuckets(uids, table)) return table;
+    }
+  }
+
+  throw std::runtime_error("No perfect hash found for UIDs.");
+}
+
+}  // namespace perfect_hash
+}  // namespace ss
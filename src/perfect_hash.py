@@ -0,0 +1,110 @@
+"""Collision free hash tables over message UIDs, built by hash and displace.
+
+A first hash, ((uid * bucket_mult) mod 2^32) >> (32 - bucket_bits), picks a bucket of about two
+UIDs.  That bucket's displacement is added to a second hash of the same form to index a power of
+two table of positions into the list of UIDs, at least as large as the list.  Buckets are placed
+largest first, so the tables are O(n) in size.  Empty slots hold len(uids), which callers point at
+a trailing "unknown" entry, so a lookup is two multiplies, two loads and one compare.
+src/perfect_hash.h implements the same search.
+"""
+
+MAX_BITS = 24
+ATTEMPTS_PER_BITS = 100
+
+
+def multiplier(attempt):
+  x = (attempt * 0x9E3779B9 + 0x7F4A7C15) & 0xFFFFFFFF
+  x ^= x >> 16
+  x = (x * 0x85EBCA6B) & 0xFFFFFFFF
+  x ^= x >> 13
+  return x | 1
+
+
+def slot(uid, mult, bits):
+  return ((uid * mult) & 0xFFFFFFFF) >> (32 - bits)
+
+
+class PerfectHash:
+
+  def __init__(self, bucket_mult, bucket_bits, mult, bits, displacements, slots):
+    self.bucket_mult = bucket_mult
+    self.bucket_bits = bucket_bits
+    self.mult = mult
+    self.bits = bits
+    self.displacements = displacements
+    self.slots = slots
+
+  @property
+  def bucket_shift(self):
+    return 32 - self.bucket_bits
+
+  @property
+  def shift(self):
+    return 32 - self.bits
+
+  @property
+  def mask(self):
+    return len(self.slots) - 1
+
+  def lookup(self, uid):
+    displacement = self.displacements[slot(uid, self.bucket_mult, self.bucket_bits)]
+    return self.slots[(slot(uid, self.mult, self.bits) + displacement) & self.mask]
+
+
+def _place_buckets(uids, bucket_mult, bucket_bits, mult, bits):
+  empty = len(uids)
+  num_slots = 1 << bits
+
+  buckets = [[] for _ in range(1 << bucket_bits)]
+  for i, uid in enumerate(uids):
+    buckets[slot(uid, bucket_mult, bucket_bits)].append(i)
+
+  # Stable, as std::stable_sort in src/perfect_hash.h.
+  order = sorted(range(len(buckets)), key=lambda b: -len(buckets[b]))
+
+  displacements = [0] * len(buckets)
+  slots = [empty] * num_slots
+  for bucket in order:
+    members = buckets[bucket]
+    if not members:
+      break
+
+    hashes = [slot(uids[i], mult, bits) for i in members]
+    for displacement in range(num_slots):
+      positions = [(h + displacement) & (num_slots - 1) for h in hashes]
+      if len(set(positions)) == len(positions) and all(slots[p] == empty for p in positions):
+        displacements[bucket] = displacement
+        for i, p in zip(members, positions):
+          slots[p] = i
+        break
+    else:
+      return None
+
+  return PerfectHash(bucket_mult, bucket_bits, mult, bits, displacements, slots)
+
+
+def find(uids):
+  if len(set(uids)) != len(uids):
+    raise ValueError('Duplicate UIDs cannot be perfectly hashed.')
+
+  if not uids:
+    return PerfectHash(1, 1, 1, 1, [0, 0], [0, 0])
+
+  # At least one slot per UID and one bucket per two UIDs.
+  bits = 1
+  while (1 << bits) < len(uids):
+    bits += 1
+  bucket_bits = 1
+  while (2 << bucket_bits) < len(uids):
+    bucket_bits += 1
+
+  while bits <= MAX_BITS:
+    for attempt in range(ATTEMPTS_PER_BITS):
+      table = _place_buckets(uids, multiplier(2 * attempt), bucket_bits,
+                             multiplier(2 * attempt + 1), bits)
+      if table:
+        return table
+    bits += 1
+    bucket_bits += 1
+
+  raise ValueError('No perfect hash found for UIDs.')
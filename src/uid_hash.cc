@@ -2,65 +2,58 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <functional>
-#include <string>
-
-#include "src/crc32.h"
 
 namespace ss {
 
+namespace {
+
+uint32_t CompositeHash(const char *name, const uint32_t *uids, size_t uids_len) {
+  uid_hash::UidHasher hasher;
+  hasher.Append(name);
+
+  for (size_t i = 0; i < uids_len; ++i) {
+    hasher.AppendItem(uids[i]);
+  }
+
+  return hasher.Finalize();
+}
+
+}  // namespace
+
 #ifdef PYTHON_LIB
 extern "C" {
 #endif
 
 uint32_t PrimitiveHash(const char *name, int packed_size) {
-  return GetCrc32(std::string(name) + ", " + std::to_string(packed_size));
+  return uid_hash::Primitive(name, packed_size);
 }
 
 uint32_t ArrayHash(uint32_t type_hash, int array_size) {
-  return GetCrc32(std::to_string(type_hash) + ", " + std::to_string(array_size));
+  return uid_hash::Array(type_hash, array_size);
 }
 
 uint32_t BitfieldFieldHash(const char *name, int bits) {
-  return GetCrc32(std::string(name) + ", " + std::to_string(bits));
+  return uid_hash::BitfieldField(name, bits);
 }
 
 uint32_t BitfieldHash(const char *name, uint32_t *field_uids, size_t field_uids_len) {
-  std::string s = name;
-
-  for (size_t i = 0; i < field_uids_len; ++i) {
-    s += ", " + std::to_string(field_uids[i]);
-  }
-
-  return GetCrc32(s);
+  return CompositeHash(name, field_uids, field_uids_len);
 }
 
 uint32_t EnumValueHash(const char *name, int value) {
-  return GetCrc32(std::string(name) + ", " + std::to_string(value));
+  return uid_hash::EnumValue(name, value);
 }
 
 uint32_t EnumHash(const char *name, uint32_t *value_uids, size_t value_uids_len) {
-  std::string s = name;
-
-  for (size_t i = 0; i < value_uids_len; ++i) {
-    s += ", " + std::to_string(value_uids[i]);
-  }
-
-  return GetCrc32(s);
+  return CompositeHash(name, value_uids, value_uids_len);
 }
 
 uint32_t StructFieldHash(const char *name, uint32_t type_hash) {
-  return GetCrc32(std::string(name) + ", " + std::to_string(type_hash));
+  return uid_hash::StructField(name, type_hash);
 }
 
 uint32_t StructHash(const char *name, uint32_t *field_uids, size_t field_uids_len) {
-  std::string s = name;
-
-  for (size_t i = 0; i < field_uids_len; ++i) {
-    s += ", " + std::to_string(field_uids[i]);
-  }
-
-  return GetCrc32(s);
+  return CompositeHash(name, field_uids, field_uids_len);
 }
 
 #ifdef PYTHON_LIB
@@ -2,6 +2,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+#include "src/crc32.h"
 
 namespace ss {
 
@@ -22,4 +26,108 @@ uint32_t StructHash(const char *name, uint32_t *field_uids, size_t field_uids_le
 }  // extern "C"
 #endif
 
+namespace uid_hash {
+
+// UIDs are the CRC32 of a canonical string: a leading name (or number) followed by ", <number>"
+// for each item, with numbers in decimal.  UidHasher streams that text straight into the CRC
+// register so no string is ever built, and everything is constexpr so UIDs can be computed (and
+// static_assert'ed) at compile time.
+class UidHasher {
+ public:
+  constexpr UidHasher& Append(std::string_view text) {
+    for (char c : text) {
+      crc_ = impl::Crc32UpdateByte(crc_, static_cast<uint8_t>(c));
+    }
+    return *this;
+  }
+
+  constexpr UidHasher& Append(int64_t value) {
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if (value < 0) {
+      crc_ = impl::Crc32UpdateByte(crc_, '-');
+      magnitude = ~magnitude + 1;
+    }
+
+    char digits[20] = {};
+    int num_digits = 0;
+    do {
+      digits[num_digits++] = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude);
+
+    while (num_digits) {
+      crc_ = impl::Crc32UpdateByte(crc_, static_cast<uint8_t>(digits[--num_digits]));
+    }
+    return *this;
+  }
+
+  constexpr UidHasher& AppendItem(int64_t value) { return Append(", ").Append(value); }
+
+  constexpr uint32_t Finalize() const { return crc_ ^ 0xFFFFFFFF; }
+
+ private:
+  uint32_t crc_ = 0xFFFFFFFF;
+};
+
+constexpr uint32_t Primitive(std::string_view name, int packed_size) {
+  return UidHasher().Append(name).AppendItem(packed_size).Finalize();
+}
+
+constexpr uint32_t Array(uint32_t type_uid, int array_size) {
+  return UidHasher().Append(type_uid).AppendItem(array_size).Finalize();
+}
+
+constexpr uint32_t BitfieldField(std::string_view name, int bits) {
+  return UidHasher().Append(name).AppendItem(bits).Finalize();
+}
+
+constexpr uint32_t EnumValue(std::string_view name, int value) {
+  return UidHasher().Append(name).AppendItem(value).Finalize();
+}
+
+constexpr uint32_t StructField(std::string_view name, uint32_t type_uid) {
+  return UidHasher().Append(name).AppendItem(type_uid).Finalize();
+}
+
+// Composite UIDs take the UIDs of their fields / values in declaration order.  Range may be any
+// container of uint32_t (std::array, std::vector, ...).
+template <typename Range>
+constexpr uint32_t Composite(std::string_view name, const Range& member_uids) {
+  UidHasher hasher;
+  hasher.Append(name);
+  for (uint32_t uid : member_uids) {
+    hasher.AppendItem(uid);
+  }
+  return hasher.Finalize();
+}
+
+template <typename Range>
+constexpr uint32_t Bitfield(std::string_view name, const Range& field_uids) {
+  return Composite(name, field_uids);
+}
+
+constexpr uint32_t Bitfield(std::string_view name, std::initializer_list<uint32_t> field_uids) {
+  return Composite(name, field_uids);
+}
+
+template <typename Range>
+constexpr uint32_t Enum(std::string_view name, const Range& value_uids) {
+  return Composite(name, value_uids);
+}
+
+constexpr uint32_t Enum(std::string_view name, std::initializer_list<uint32_t> value_uids) {
+  return Composite(name, value_uids);
+}
+
+template <typename Range>
+constexpr uint32_t Struct(std::string_view name, const Range& field_uids) {
+  return Composite(name, field_uids);
+}
+
+constexpr uint32_t Struct(std::string_view name, std::initializer_list<uint32_t> field_uids) {
+  return Composite(name, field_uids);
+}
+
+}  // namespace uid_hash
+
 }  // namespace ss
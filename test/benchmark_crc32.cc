@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "src/crc32.h"
+
+using namespace ss;
+
+using Kernel = std::function<uint32_t(const uint8_t *, size_t)>;
+
+// Returns throughput in MB/s.
+static double Benchmark(const Kernel& kernel, const std::vector<uint8_t>& data, size_t len) {
+  const size_t iterations = (size_t{256} << 20) / len + 1;
+
+  volatile uint32_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    sink = sink ^ kernel(data.data(), len);
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  return static_cast<double>(iterations * len) / seconds / 1e6;
+}
+
+int main() {
+  const std::vector<std::pair<const char *, Kernel>> kernels = {
+      {"bytewise", [](const uint8_t *buf,
+                      size_t len) { return impl::Crc32UpdateBytewise(0xFFFFFFFF, buf, len); }},
+      {"slice8", [](const uint8_t *buf,
+                    size_t len) { return impl::Crc32UpdateSlice8(0xFFFFFFFF, buf, len); }},
+      {"slice16", [](const uint8_t *buf,
+                     size_t len) { return impl::Crc32UpdateSlice16(0xFFFFFFFF, buf, len); }},
+#ifdef SS_X86
+      {"clmul",
+       [](const uint8_t *buf, size_t len) {
+         if (!impl::Crc32ClmulSupported() || len < impl::kCrc32ClmulMinLen) return 0u;
+         return impl::Crc32UpdateClmul(0xFFFFFFFF, buf, len);
+       }},
+#endif
+      {"GetCrc32", [](const uint8_t *buf, size_t len) { return GetCrc32(buf, len); }},
+  };
+
+  const std::vector<size_t> lengths = {64, 256, 4096, 1 << 20};
+
+  std::vector<uint8_t> data(lengths.back());
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+
+  printf("%-10s", "len");
+  for (const auto& kernel : kernels) printf("%14s", kernel.first);
+  printf("\n");
+
+  for (size_t len : lengths) {
+    printf("%-10zu", len);
+    for (const auto& kernel : kernels) {
+      printf("%9.0f MB/s", Benchmark(kernel.second, data, len));
+    }
+    printf("\n");
+  }
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "src/dynamic/column_batch.h"
+#include "src/dynamic/type_descriptors.h"
+
+using namespace ss::dynamic;
+
+// Best of a few runs, in seconds.
+template <typename F>
+static double BestSeconds(F f) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < 5; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  return best;
+}
+
+int main() {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile("test/test_message_spec.yaml");
+  const size_t rows = 2000000;
+
+  printf("%-20s %10s %14s %14s\n", "type", "MB", "decode GB/s", "memcpy GB/s");
+  for (const char *name : {"PrimitiveTest", "ArrayTest", "Bitfield4BytesTest"}) {
+    const TypeDescriptor& type = *types[name];
+
+    std::vector<uint8_t> data(rows * type.packed_size());
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<uint8_t>(i * 31 + 5);
+    }
+    std::vector<uint8_t> copy(data.size());
+
+    ColumnBatch batch(type);
+    const double decode = BestSeconds([&] { batch.Decode(data.data(), rows); });
+    const double memcpy_seconds =
+        BestSeconds([&] { memcpy(copy.data(), data.data(), data.size()); });
+
+    const double gb = data.size() / 1e9;
+    printf("%-20s %10.0f %14.2f %14.2f\n", name, gb * 1e3, gb / decode, gb / memcpy_seconds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/packing.h"
+#include "src/dynamic/type_descriptors.h"
+
+using namespace ss::dynamic;
+
+static std::string BenchmarkSpec(int num_structs, int num_fields) {
+  static const char *kPrims[] = {"uint8", "int16", "uint32", "int64", "float", "double", "bool"};
+
+  std::string spec = "Flags:\n  type: Bitfield\n  fields:\n    - a: 3\n    - b: 9\n";
+  for (int i = 0; i < num_structs; ++i) {
+    spec += "Struct" + std::to_string(i) + ":\n  type: Struct\n  fields:\n";
+    for (int j = 0; j < num_fields; ++j) {
+      spec += "    - field" + std::to_string(j) + ": " + kPrims[(i + j) % 7] + "\n";
+    }
+    spec += "    - flags: Flags\n";
+  }
+
+  spec += "Benchmark:\n  type: Message\n  fields:\n";
+  for (int i = 0; i < num_structs; ++i) {
+    spec += "    - struct" + std::to_string(i) + ": [Struct" + std::to_string(i) + ", 4]\n";
+  }
+
+  return spec;
+}
+
+// Best of a few runs of UnpackMessage over the same packed message, in ns per message.
+//
+// Only API that predates the descriptor arena is used, so the same file also builds against the
+// baseline tree: copy it into a `git worktree` of the baseline commit and run the same target
+// there.  Pass --decode_only or --traverse_only to run a single measurement, e.g. under
+// `perf stat -e cache-references,cache-misses` to compare cache misses between the two builds.
+static double NsPerMessage(const DescriptorBuilder& types, const std::vector<uint8_t>& buffer) {
+  const int iterations = 200;
+
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < 5; ++run) {
+    volatile size_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      const auto [msg, status] = UnpackMessage(buffer.data(), buffer.size(), types);
+      if (status != UnpackStatus::kSuccess) throw std::runtime_error("Unpack failed.");
+      sink = sink + msg->descriptor().packed_size();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+  }
+
+  return best / iterations;
+}
+
+// Sum of every field offset reachable from type, touching each descriptor the way a decoder walking
+// the graph would.
+static int64_t Walk(const TypeDescriptor& type) {
+  int64_t sum = type.packed_size();
+  if (type.IsArray()) {
+    for (int i = 0; i < type.array_size(); ++i) {
+      sum += Walk(type.array_elem_type());
+    }
+  } else if (type.IsStruct()) {
+    for (const auto& field : type.struct_fields()) {
+      sum += field->offset() + Walk(field->type());
+    }
+  } else if (type.IsBitfield()) {
+    for (const auto& field : type.struct_fields()) {
+      sum += field->bit_offset() + field->bit_size();
+    }
+  }
+  return sum;
+}
+
+// Best of a few full walks of the descriptor graph, in ns per field visited.  Isolates descriptor
+// layout (arena vs. separate heap nodes) from the rest of the decode path.
+static double NsPerField(const TypeDescriptor& msg, int64_t num_fields) {
+  const int iterations = 20;
+
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < 20; ++run) {
+    volatile int64_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      sink = sink + Walk(msg);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+  }
+
+  return best / iterations / num_fields;
+}
+
+template <typename T>
+static void AddLines(const T *object, std::unordered_set<uintptr_t>& lines) {
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(object);
+  for (uintptr_t line = begin / 64; line <= (begin + sizeof(T) - 1) / 64; ++line) {
+    lines.insert(line);
+  }
+}
+
+// Distinct 64 byte cache lines holding the descriptors, field list entries and fields that Walk
+// reads, i.e. how many lines a cold walk has to miss on.  Unlike perf this needs no hardware
+// counters, so it also works in VMs that expose none.
+static void WalkLines(const TypeDescriptor& type, std::unordered_set<const void *>& visited,
+                      std::unordered_set<uintptr_t>& lines) {
+  if (!visited.insert(&type).second) return;
+
+  AddLines(&type, lines);
+  if (type.IsArray()) {
+    WalkLines(type.array_elem_type(), visited, lines);
+  } else if (type.IsStruct() || type.IsBitfield()) {
+    for (const auto& field : type.struct_fields()) {
+      AddLines(&field, lines);
+      AddLines(&*field, lines);
+      if (type.IsStruct()) WalkLines(field->type(), visited, lines);
+    }
+  }
+}
+
+static size_t CacheLines(const TypeDescriptor& msg) {
+  std::unordered_set<const void *> visited;
+  std::unordered_set<uintptr_t> lines;
+  WalkLines(msg, visited, lines);
+  return lines.size();
+}
+
+static std::string WideSpec(int num_values, int num_fields) {
+  std::string spec = "WideEnum:\n  type: Enum\n  values:\n";
+  for (int i = 0; i < num_values; ++i) {
+    spec += "    - Value" + std::to_string(i) + ":\n";
+  }
+
+  spec += "WideMessage:\n  type: Message\n  fields:\n";
+  for (int i = 0; i < num_fields; ++i) {
+    spec += "    - field" + std::to_string(i) + ": uint32\n";
+  }
+
+  return spec;
+}
+
+static double BuildSeconds(const std::string& spec) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < 3; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    DescriptorBuilder::FromString(spec);
+    const auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  return best;
+}
+
+int main(int argc, char **argv) {
+  const std::string mode = argc > 1 ? argv[1] : "";
+
+  if (mode.empty() || mode == "--traverse_only") {
+    // Large enough that the descriptor graph does not fit in L2.
+    const int num_structs = 2000;
+    const int num_fields = 32;
+    const DescriptorBuilder types =
+        DescriptorBuilder::FromString(BenchmarkSpec(num_structs, num_fields));
+    // Each struct is repeated 4 times and holds num_fields fields plus a 2 field bitfield.
+    const int64_t visited = int64_t{num_structs} * 4 * (num_fields + 1 + 2);
+    printf("descriptor walk: %.2f ns / field\n", NsPerField(*types["Benchmark"], visited));
+    printf("descriptor walk: %zu distinct cache lines\n", CacheLines(*types["Benchmark"]));
+  }
+
+  if (mode.empty() || mode == "--decode_only") {
+    const DescriptorBuilder types = DescriptorBuilder::FromString(BenchmarkSpec(100, 24));
+    const TypeDescriptor& msg = *types["Benchmark"];
+
+    std::vector<uint8_t> buffer(msg.packed_size());
+    for (size_t i = 0; i < buffer.size(); ++i) {
+      buffer[i] = static_cast<uint8_t>(i * 31 + 5);
+    }
+    PackBe<uint32_t>(msg.uid(), buffer.data());
+    PackBe<uint16_t>(msg.packed_size(), buffer.data() + 4);
+
+    printf("message: %d bytes\n", msg.packed_size());
+    printf("UnpackMessage: %.0f ns / message\n", NsPerMessage(types, buffer));
+  }
+
+  if (!mode.empty()) return 0;
+
+  // Linear build time roughly quadruples per row, quadratic grows 16x.
+  printf("\n%-8s %8s %14s\n", "values", "fields", "build ms");
+  for (int scale = 1; scale <= 16; scale *= 4) {
+    const double seconds = BuildSeconds(WideSpec(2000 * scale, 500 * scale));
+    printf("%-8d %8d %14.1f\n", 2000 * scale, 500 * scale, seconds * 1e3);
+  }
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/column_batch.h"
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/type_descriptors.h"
+
+using namespace ss::dynamic;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+static std::vector<std::string> ColumnNames(const ColumnBatch& batch) {
+  std::vector<std::string> names;
+  for (const ColumnBatch::Column& column : batch.columns()) names.push_back(column.name());
+  return names;
+}
+
+TEST(ColumnBatch, Columns) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  EXPECT_THAT(ColumnNames(ColumnBatch(*types["Bitfield4BytesTest"])),
+              ElementsAre("ss_header.uid", "ss_header.len", "bitfield.field0", "bitfield.field1",
+                          "bitfield.field2"));
+
+  const ColumnBatch array_batch(*types["ArrayTest"]);
+  EXPECT_EQ(array_batch.columns().size(), 2 + (3 + 6 + 6) * 2);
+  EXPECT_EQ(array_batch.columns()[2].name(), "array_1d[0].field0");
+  EXPECT_EQ(array_batch.columns().back().name(), "array_3d[0][1][2].field1");
+  EXPECT_EQ(array_batch["array_2d[1][0].field1"]->prim_type(), TypeDescriptor::PrimType::kUint16);
+  EXPECT_EQ(array_batch["array_2d[1][0]"], nullptr);
+
+  EXPECT_THROW(ColumnBatch{*types["Bitfield4Bytes"]}, std::runtime_error);
+}
+
+TEST(ColumnBatch, Decode) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["Bitfield4BytesTest"];
+
+  // Three rows packed back to back.
+  std::vector<uint8_t> bytes;
+  for (int row = 0; row < 3; ++row) {
+    DynamicStruct structure(type);
+    DynamicStruct& bitfield = structure.Get<DynamicStruct>("bitfield");
+    bitfield.Get<uint8_t>("field0") = row;
+    bitfield.Get<uint8_t>("field1") = 27;
+    bitfield.Get<uint16_t>("field2") = 264 + row;
+    structure.Get<DynamicStruct>("ss_header").Get<uint32_t>("uid") = 0x01020304 * row;
+
+    bytes.resize(bytes.size() + type.packed_size());
+    structure.Pack(bytes.data() + bytes.size() - type.packed_size());
+  }
+
+  // Columns are typed before anything is decoded.
+  ColumnBatch batch(type);
+  EXPECT_TRUE(batch.values<uint16_t>("bitfield.field2").empty());
+  EXPECT_THROW(batch.values<uint8_t>("bitfield.field2"), std::bad_variant_access);
+
+  batch.Decode(bytes.data(), 3);
+  ASSERT_EQ(batch.size(), 3);
+
+  EXPECT_THAT(batch.values<uint32_t>("ss_header.uid"), ElementsAre(0, 0x01020304, 0x02040608));
+  EXPECT_THAT(batch.values<uint8_t>("bitfield.field0"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(batch.values<uint8_t>("bitfield.field1"), ElementsAre(27, 27, 27));
+  EXPECT_THAT(batch.values<uint16_t>("bitfield.field2"), ElementsAre(264, 265, 266));
+
+  EXPECT_THROW(batch.values<uint32_t>("bitfield.field2"), std::bad_variant_access);
+  EXPECT_THROW(batch.values<uint16_t>("bitfield.field3"), std::out_of_range);
+
+  // Separate buffers, fewer rows.
+  const uint8_t *buffers[] = {bytes.data() + 2 * type.packed_size(), bytes.data()};
+  batch.Decode(buffers, 2);
+  ASSERT_EQ(batch.size(), 2);
+  EXPECT_THAT(batch.values<uint16_t>("bitfield.field2"), ElementsAre(266, 264));
+
+  // More rows than before.
+  const uint8_t *more[] = {bytes.data(), bytes.data(), bytes.data(), bytes.data()};
+  batch.Decode(more, 4);
+  EXPECT_THAT(batch.values<uint16_t>("bitfield.field2"), ElementsAre(264, 264, 264, 264));
+}
+
+TEST(ColumnBatch, BoolNormalized) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["PrimitiveTest"];
+
+  ColumnBatch batch(type);
+  const uint32_t offset = batch["boolean"]->accessor().offset();
+
+  // Any nonzero wire byte is true, and is stored as a valid bool.
+  std::vector<uint8_t> bytes(3 * type.packed_size());
+  bytes[offset] = 233;
+  bytes[2 * type.packed_size() + offset] = 1;
+  batch.Decode(bytes.data(), 3);
+
+  uint8_t stored[3];
+  memcpy(stored, batch.values<bool>("boolean").data(), sizeof(stored));
+  EXPECT_THAT(stored, ElementsAre(1, 0, 1));
+}
+
+TEST(ColumnBatch, MatchesDynamicStruct) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  for (const char *name : {"PrimitiveTest", "ArrayTest", "Enum2BytesTest", "AliasTest"}) {
+    const TypeDescriptor& type = *types[name];
+
+    // Bytes of 0 or 1 keep floats finite and bools valid.
+    const size_t rows = 5;
+    std::vector<uint8_t> bytes(rows * type.packed_size());
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = (i * 7 / 3) % 2;
+
+    ColumnBatch batch(type);
+    batch.Decode(bytes.data(), rows);
+
+    SCOPED_TRACE(name);
+    for (size_t row = 0; row < rows; ++row) {
+      for (const ColumnBatch::Column& column : batch.columns()) {
+        const double expected = column.accessor().Convert<double>(&bytes[row * type.packed_size()]);
+        double actual = 0;
+        switch (column.prim_type()) {
+          case TypeDescriptor::PrimType::kUint8:
+            actual = column.values<uint8_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kUint16:
+            actual = column.values<uint16_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kUint32:
+            actual = column.values<uint32_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kUint64:
+            actual = column.values<uint64_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kInt8:
+            actual = column.values<int8_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kInt16:
+            actual = column.values<int16_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kInt32:
+            actual = column.values<int32_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kInt64:
+            actual = column.values<int64_t>()[row];
+            break;
+          case TypeDescriptor::PrimType::kBool:
+            actual = column.values<bool>()[row];
+            break;
+          case TypeDescriptor::PrimType::kFloat:
+            actual = column.values<float>()[row];
+            break;
+          case TypeDescriptor::PrimType::kDouble:
+            actual = column.values<double>()[row];
+            break;
+        }
+        EXPECT_EQ(actual, expected) << column.name() << " row " << row;
+      }
+    }
+  }
+}
@@ -0,0 +1,249 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/descriptor_registry.h"
+#include "src/dynamic/dynamic_types.h"
+
+using namespace ss::dynamic;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+const std::string kBlobFile = "test/test_message_spec.ssdb";
+
+constexpr uint32_t kPrimitiveTestUid = 710579723;
+
+// Same PrimitiveTest as the test spec plus a message of its own.
+const std::string kOtherSpec = R"(
+PrimitiveTest:
+  type: Message
+  fields:
+    - uint8: uint8
+    - uint16: uint16
+    - uint32: uint32
+    - uint64: uint64
+    - int8: int8
+    - int16: int16
+    - int32: int32
+    - int64: int64
+    - boolean: bool
+    - float_type: float
+    - double_type: double
+
+OtherMessage:
+  type: Message
+  fields:
+    - value: uint32
+)";
+
+const std::string kOtherSpecV2 = R"(
+OtherMessage:
+  type: Message
+  fields:
+    - value: uint32
+    - extra: uint8
+)";
+
+static std::vector<uint8_t> ReadFile(const std::string& filename) {
+  std::ifstream ifs(filename, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)),
+                              std::istreambuf_iterator<char>());
+}
+
+TEST(DescriptorRegistry, Empty) {
+  DescriptorRegistry registry;
+  auto types = registry.Read();
+  EXPECT_THAT(types->specs(), IsEmpty());
+  EXPECT_THAT(types->types(), IsEmpty());
+  EXPECT_EQ(types->LookupMsgFromUid(0), nullptr);
+  EXPECT_EQ(types->LookupMsgFromUid(kPrimitiveTestUid), nullptr);
+  EXPECT_EQ((*types)["SsHeader"], nullptr);
+}
+
+TEST(DescriptorRegistry, MergeDeduplicates) {
+  auto test_spec =
+      std::make_shared<const DescriptorBuilder>(DescriptorBuilder::FromFile(kYamlFile));
+  auto other_spec =
+      std::make_shared<const DescriptorBuilder>(DescriptorBuilder::FromString(kOtherSpec));
+
+  DescriptorRegistry registry;
+  registry.Publish("test", test_spec);
+  registry.Publish("other", other_spec);
+
+  auto types = registry.Read();
+  ASSERT_EQ(types->specs().size(), 2);
+  EXPECT_EQ(types->specs()[0].name, "test");
+  EXPECT_EQ(types->specs()[1].name, "other");
+
+  // First published spec wins.
+  EXPECT_EQ(types->LookupMsgFromUid(kPrimitiveTestUid), (*test_spec)["PrimitiveTest"]);
+  EXPECT_EQ((*types)["PrimitiveTest"], (*test_spec)["PrimitiveTest"]);
+  EXPECT_EQ(types->LookupTypeFromUid((*other_spec)["uint8"]->uid()), (*test_spec)["uint8"]);
+
+  const TypeDescriptor *other_msg = (*other_spec)["OtherMessage"];
+  EXPECT_EQ(types->LookupMsgFromUid(other_msg->uid()), other_msg);
+  EXPECT_EQ(types->LookupMsgFromUid((*test_spec)["uint8"]->uid()), nullptr);
+
+  // Only OtherMessage (and its SsHeader-prefixed layout) is new.
+  EXPECT_EQ(types->types().size(), test_spec->types().size() + 1);
+}
+
+TEST(DescriptorRegistry, ReplaceAndRemove) {
+  DescriptorRegistry registry;
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpec));
+
+  const uint32_t v1_uid = (*registry.Read())["OtherMessage"]->uid();
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpecV2));
+
+  {
+    auto types = registry.Read();
+    ASSERT_EQ(types->specs().size(), 1);
+    EXPECT_EQ(types->LookupMsgFromUid(v1_uid), nullptr);
+    EXPECT_EQ(types->LookupMsgFromUid(kPrimitiveTestUid), nullptr);
+    EXPECT_EQ((*types)["OtherMessage"]->packed_size(), 6 + 5);
+  }
+
+  EXPECT_FALSE(registry.Remove("test"));
+  EXPECT_TRUE(registry.Remove("other"));
+  EXPECT_THAT(registry.Read()->specs(), IsEmpty());
+}
+
+TEST(DescriptorRegistry, Blob) {
+  const std::vector<uint8_t> blob = ReadFile(kBlobFile);
+  DescriptorRegistry registry;
+  registry.Publish("blob", DescriptorBuilder::FromBlob(blob.data(), blob.size()));
+
+  auto types = registry.Read();
+  const TypeDescriptor *msg = types->LookupMsgFromUid(kPrimitiveTestUid);
+  ASSERT_NE(msg, nullptr);
+  EXPECT_EQ(msg->name(), "PrimitiveTest");
+}
+
+TEST(DescriptorRegistry, UnpackMessage) {
+  DescriptorRegistry registry;
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpec));
+
+  auto types = registry.Read();
+  const TypeDescriptor& msg_type = *(*types)["OtherMessage"];
+  const uint32_t uid = msg_type.uid();
+  const uint8_t bytes[] = {
+      static_cast<uint8_t>(uid >> 24),
+      static_cast<uint8_t>(uid >> 16),
+      static_cast<uint8_t>(uid >> 8),
+      static_cast<uint8_t>(uid),
+      0x00,
+      0x0A,
+      0x12,
+      0x34,
+      0x56,
+      0x78,
+  };
+
+  auto [msg, status] = UnpackMessage(bytes, sizeof(bytes), *types);
+  ASSERT_EQ(status, UnpackStatus::kSuccess);
+  EXPECT_EQ(msg->Get<uint32_t>("value"), 0x12345678);
+}
+
+TEST(DescriptorRegistry, PublishWaitsForReaders) {
+  DescriptorRegistry registry;
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpec));
+
+  std::atomic<bool> published = false;
+  std::thread writer;
+  {
+    auto types = registry.Read();
+    writer = std::thread([&] {
+      registry.Publish("other", DescriptorBuilder::FromString(kOtherSpecV2));
+      published = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(published);
+
+    // The old snapshot and its descriptors are still intact.
+    EXPECT_EQ((*types)["OtherMessage"]->packed_size(), 6 + 4);
+  }
+
+  writer.join();
+  EXPECT_TRUE(published);
+  EXPECT_EQ((*registry.Read())["OtherMessage"]->packed_size(), 6 + 5);
+}
+
+TEST(DescriptorRegistry, ReadShared) {
+  DescriptorRegistry registry;
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpec));
+
+  const std::shared_ptr<const DescriptorRegistry::Snapshot> types = registry.ReadShared();
+  EXPECT_EQ(types.get(), &*registry.Read());
+
+  // Does not wait for the shared snapshot, which outlives its replacement.
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpecV2));
+  registry.Remove("other");
+  EXPECT_EQ((*registry.Read())["OtherMessage"], nullptr);
+  EXPECT_EQ((*types)["OtherMessage"]->packed_size(), 6 + 4);
+}
+
+TEST(MessageDecoder, SharesSnapshot) {
+  DescriptorRegistry registry;
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpec));
+
+  MessageDecoder decoder(registry.ReadShared());
+  static_assert(std::is_same_v<decltype(decoder), MessageDecoder<DescriptorRegistry::Snapshot>>);
+
+  uint8_t bytes[6 + 4];
+  {
+    DynamicStruct msg(*(*registry.Read())["OtherMessage"]);
+    msg.Get<uint32_t>("value") = 0x12345678;
+    ASSERT_EQ(PackMessage(msg, bytes, sizeof(bytes)), sizeof(bytes));
+  }
+
+  // Publishing goes ahead while the decoder is alive; it keeps decoding with its snapshot.
+  registry.Publish("other", DescriptorBuilder::FromString(kOtherSpecV2));
+  const auto [msg, status] = decoder.Unpack(bytes, sizeof(bytes));
+  ASSERT_EQ(status, UnpackStatus::kSuccess);
+  EXPECT_EQ(msg->Get<uint32_t>("value"), 0x12345678);
+
+  EXPECT_THROW(MessageDecoder(std::shared_ptr<const DescriptorRegistry::Snapshot>()),
+               std::runtime_error);
+}
+
+TEST(DescriptorRegistry, ConcurrentReload) {
+  DescriptorRegistry registry;
+  registry.Publish("test", DescriptorBuilder::FromFile(kYamlFile));
+
+  const std::vector<std::string> specs = {kOtherSpec, kOtherSpecV2};
+  std::atomic<bool> done = false;
+  std::atomic<int> failures = 0;
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done) {
+        auto types = registry.Read();
+        const TypeDescriptor *msg = types->LookupMsgFromUid(kPrimitiveTestUid);
+        if (!msg || msg->name() != "PrimitiveTest") ++failures;
+
+        const TypeDescriptor *other = (*types)["OtherMessage"];
+        if (other && types->LookupMsgFromUid(other->uid()) != other) ++failures;
+      }
+    });
+  }
+
+  for (int i = 0; i < 50; ++i) {
+    registry.Publish("other", DescriptorBuilder::FromString(specs[i % specs.size()]));
+    if (i % 10 == 9) registry.Remove("other");
+  }
+
+  done = true;
+  for (auto& reader : readers) reader.join();
+
+  EXPECT_EQ(failures, 0);
+}
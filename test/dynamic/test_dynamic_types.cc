@@ -1,7 +1,13 @@
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -101,8 +107,27 @@ TEST(DynamicStruct, GetConvertIf) {
 
   EXPECT_EQ(structure.GetIf<uint8_t>("uint9"), nullptr);
   EXPECT_EQ(*structure.GetIf<uint8_t>("uint8"), 1);
+  EXPECT_EQ(structure.GetIf<DynamicStruct>("ss_header"),
+            &structure.Get<DynamicStruct>("ss_header"));
   EXPECT_EQ(structure.ConvertIf<float>("uint9"), std::nullopt);
   EXPECT_FLOAT_EQ(*structure.ConvertIf<float>("uint8"), 1.0f);
+
+  // Fields from another type are not found.
+  const FieldDescriptor& other_field = *(*types["ArrayElem"])["field0"];
+  EXPECT_EQ(structure.GetIf<bool>(other_field), nullptr);
+  EXPECT_EQ(structure.ConvertIf<int>(other_field), std::nullopt);
+  EXPECT_THROW(structure.Get<bool>(other_field), std::out_of_range);
+}
+
+TEST(DynamicStruct, UnknownField) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  DynamicStruct structure(*types["PrimitiveTest"]);
+  const DynamicStruct& const_structure = structure;
+
+  EXPECT_THROW(structure.Get<uint8_t>("uint9"), std::out_of_range);
+  EXPECT_THROW(const_structure.Get<uint8_t>("uint9"), std::out_of_range);
+  EXPECT_THROW(structure.Get<DynamicStruct>("header"), std::out_of_range);
+  EXPECT_THROW(structure.Convert<float>("uint9"), std::out_of_range);
 }
 
 TEST(DynamicStruct, Copy) {
@@ -121,6 +146,105 @@ TEST(DynamicStruct, Copy) {
   EXPECT_EQ(structure.Get<uint8_t>("uint8"), 1);
 }
 
+TEST(DynamicStruct, Handles) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  ASSERT_THAT(types.types(), Contains(Key("AliasTest")));
+
+  DynamicStruct structure(*types["AliasTest"]);
+
+  // Nested values write through to the parent.
+  DynamicArray& position = structure.Get<DynamicArray>("position");
+  position.Get<float>(2) = 3.0f;
+  structure.Get<DynamicStruct>("velocity").Get<float>("y") = 4.0f;
+  EXPECT_EQ(structure.Get<DynamicArray>("position").Get<float>(2), 3.0f);
+  EXPECT_EQ(structure.Get<DynamicArray>("position").Convert<int>(2), 3);
+  EXPECT_THROW(position.Get<double>(2), std::bad_variant_access);
+
+  // Copies of nested values are independent.
+  EXPECT_EQ(&structure.Get<DynamicStruct>("velocity"), &structure.Get<DynamicStruct>("velocity"));
+  DynamicStruct velocity_copy = structure.Get<DynamicStruct>("velocity");
+  velocity_copy.Get<float>("y") = 5.0f;
+  EXPECT_EQ(structure.Get<DynamicStruct>("velocity").Get<float>("y"), 4.0f);
+
+  // Assigning to a nested value writes through.
+  structure.Get<DynamicStruct>("velocity") = velocity_copy;
+  EXPECT_EQ(structure.Get<DynamicStruct>("velocity").Get<float>("y"), 5.0f);
+  EXPECT_THROW(structure.Get<DynamicStruct>("velocity") = structure, std::runtime_error);
+
+  // Copying the parent copies nested values.
+  DynamicStruct copy = structure;
+  copy.Get<DynamicArray>("position").Get<float>(2) = 6.0f;
+  EXPECT_EQ(structure.Get<DynamicArray>("position").Get<float>(2), 3.0f);
+}
+
+TEST(DynamicStruct, MovedFrom) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  ASSERT_THAT(types.types(), Contains(Key("AliasTest")));
+
+  DynamicStruct a(*types["AliasTest"]);
+  DynamicStruct b(*types["AliasTest"]);
+  a.Get<DynamicStruct>("velocity").Get<float>("x") = 1.0f;
+  b.Get<DynamicStruct>("velocity").Get<float>("x") = 2.0f;
+
+  std::swap(a, b);
+  EXPECT_EQ(a.Get<DynamicStruct>("velocity").Get<float>("x"), 2.0f);
+  EXPECT_EQ(b.Get<DynamicStruct>("velocity").Get<float>("x"), 1.0f);
+
+  // A moved from value can be assigned to again, by copy or by move.
+  DynamicStruct moved = std::move(a);
+  a = b;
+  EXPECT_EQ(a.Get<DynamicStruct>("velocity").Get<float>("x"), 1.0f);
+  DynamicStruct moved_again = std::move(a);
+  a = std::move(moved);
+  EXPECT_EQ(a.Get<DynamicStruct>("velocity").Get<float>("x"), 2.0f);
+
+  // Moving a nested value makes another handle, leaving the nested value in place.
+  DynamicStruct velocity = std::move(a.Get<DynamicStruct>("velocity"));
+  velocity.Get<float>("x") = 3.0f;
+  EXPECT_EQ(a.Get<DynamicStruct>("velocity").Get<float>("x"), 3.0f);
+
+  // Copies of a moved from value are empty too, and a field cannot be assigned one.
+  DynamicStruct source = std::move(b);
+  DynamicStruct copy = b;
+  copy = b;
+  copy = source;
+  EXPECT_EQ(copy.Get<DynamicStruct>("velocity").Get<float>("x"), 1.0f);
+
+  DynamicStruct empty_velocity = a.Get<DynamicStruct>("velocity");
+  DynamicStruct taken = std::move(empty_velocity);
+  EXPECT_THROW(a.Get<DynamicStruct>("velocity") = empty_velocity, std::runtime_error);
+  EXPECT_THROW(velocity = empty_velocity, std::runtime_error);
+  EXPECT_EQ(a.Get<DynamicStruct>("velocity").Get<float>("x"), 3.0f);
+}
+
+TEST(DynamicArray, MovedFrom) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  ASSERT_THAT(types.types(), Contains(Key("ArrayTest")));
+
+  const TypeDescriptor& array_type = (*types["ArrayTest"])["array_2d"]->type();
+  DynamicArray a(array_type);
+  DynamicArray b(array_type);
+  a.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1") = 1;
+  b.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1") = 2;
+
+  std::swap(a, b);
+  EXPECT_EQ(a.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1"), 2);
+  EXPECT_EQ(b.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1"), 1);
+
+  DynamicArray moved = std::move(a);
+  a = b;
+  EXPECT_EQ(a.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1"), 1);
+  DynamicArray moved_again = std::move(a);
+  a = std::move(moved);
+  EXPECT_EQ(a.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1"), 2);
+
+  DynamicArray source = std::move(b);
+  DynamicArray copy = b;
+  copy = b;
+  copy = source;
+  EXPECT_EQ(copy.Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>("field1"), 1);
+}
+
 TEST(DynamicArray, ElemAccess) {
   DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
   ASSERT_THAT(types.types(), Contains(Key("ArrayTest")));
@@ -175,6 +299,61 @@ TEST(DynamicStruct, UnpackBitfield) {
   EXPECT_EQ(structure.Get<DynamicStruct>("bitfield").Get<uint16_t>("field2"), 264);
 }
 
+TEST(DynamicStruct, BitfieldPlanRoundTrip) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& bitfield = *types["Bitfield4BytesTest"];
+  ASSERT_LE(bitfield.value_size(), 64);
+
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x01, 0x08, 0xde,
+  };
+
+  alignas(8) uint8_t values[64] = {};
+  impl::ExecuteUnpackPlan(bitfield.unpack_plan(), bytes, values);
+
+  uint8_t packed[10];
+  memset(packed, 0xFF, sizeof(packed));
+  impl::ExecutePackPlan(bitfield.unpack_plan(), values, packed);
+  EXPECT_THAT(packed, ElementsAreArray(bytes));
+}
+
+TEST(DynamicStruct, PortableRunPath) {
+  DescriptorBuilder types = DescriptorBuilder::FromString(R"(
+Runs:
+  type: Message
+  fields:
+    - bytes: [uint8, 7]
+    - halves: [uint16, 19]
+    - floats: [float, 11]
+    - longs: [int64, 5]
+    - doubles: [double, 3]
+)");
+  const TypeDescriptor& runs = *types["Runs"];
+
+  std::vector<uint8_t> bytes(runs.packed_size());
+  for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<uint8_t>(i * 37 + 11);
+
+  // No SSSE3, whatever this CPU has, against the detected path.
+  const ss::CpuFeatures portable_features;
+  std::vector<uint64_t> portable(runs.value_size() / sizeof(uint64_t) + 1);
+  std::vector<uint64_t> detected(portable.size());
+  uint8_t *portable_values = reinterpret_cast<uint8_t *>(portable.data());
+  uint8_t *detected_values = reinterpret_cast<uint8_t *>(detected.data());
+  impl::ExecuteUnpackPlan(runs.unpack_plan(), bytes.data(), portable_values, portable_features);
+  impl::ExecuteUnpackPlan(runs.unpack_plan(), bytes.data(), detected_values);
+  EXPECT_EQ(memcmp(portable_values, detected_values, runs.value_size()), 0);
+
+  const FieldDescriptor& halves = *runs["halves"];
+  EXPECT_EQ(impl::LoadValue<uint16_t>(detected_values + halves.value_offset() + 18 * 2),
+            UnpackBe<uint16_t>(bytes.data() + halves.offset() + 18 * 2));
+
+  std::vector<uint8_t> packed(bytes.size());
+  impl::ExecutePackPlan(runs.unpack_plan(), detected_values, packed.data());
+  EXPECT_EQ(packed, bytes);
+  impl::ExecutePackPlan(runs.unpack_plan(), portable_values, packed.data(), portable_features);
+  EXPECT_EQ(packed, bytes);
+}
+
 TEST(DynamicStruct, UnpackEnum) {
   DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
   ASSERT_THAT(types.types(), Contains(Key("Enum2BytesTest")));
@@ -325,6 +504,224 @@ TEST(DynamicStruct, UnpackArray) {
             5);
 }
 
+TEST(DynamicStruct, UnpackAfterCopy) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  ASSERT_THAT(types.types(), Contains(Key("Enum2BytesTest")));
+
+  DynamicStruct structure(*types["Enum2BytesTest"]);
+
+  const uint8_t first[] = {0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x80};
+  const uint8_t second[] = {0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x05};
+
+  structure.Unpack(first);
+  DynamicStruct copy = structure;
+  copy.Unpack(second);
+
+  // Each object decodes into its own storage.
+  EXPECT_EQ(structure.Get<int16_t>("enumeration"), 128);
+  EXPECT_EQ(copy.Get<int16_t>("enumeration"), 5);
+
+  DynamicStruct moved = std::move(copy);
+  moved.Unpack(first);
+  EXPECT_EQ(moved.Get<int16_t>("enumeration"), 128);
+}
+
+TEST(DynamicArray, Unpack) {
+  DescriptorBuilder types = DescriptorBuilder::FromString(R"(
+Nested:
+  type: Message
+  fields:
+    - values: [[int16, 3], 2]
+)");
+
+  const TypeDescriptor& values_type = (*types["Nested"])["values"]->type();
+  DynamicArray array(values_type);
+
+  const uint8_t bytes[] = {0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0xff, 0xfc, 0xff, 0xfb, 0xff, 0xfa};
+  array.Unpack(bytes);
+
+  EXPECT_EQ(array.Get<DynamicArray>(0).Convert<int>(0), 1);
+  EXPECT_EQ(array.Get<DynamicArray>(0).Convert<int>(2), 3);
+  EXPECT_EQ(array.Get<DynamicArray>(1).Convert<int>(0), -4);
+  EXPECT_EQ(array.Get<DynamicArray>(1).Convert<int>(2), -6);
+}
+
+TEST(DynamicArray, AsSpan) {
+  DescriptorBuilder types = DescriptorBuilder::FromString(R"(
+Samples:
+  type: Message
+  fields:
+    - count: uint8
+    - values: [float, 4]
+    - nested: [[int16, 3], 2]
+)");
+
+  const uint8_t bytes[] = {
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ss_header
+      0x03,  // count
+      0x3f, 0x80, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00,  // values
+      0x40, 0x40, 0x00, 0x00, 0xc0, 0x80, 0x00, 0x00,
+      0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0xff, 0xfc, 0xff, 0xfb, 0xff, 0xfa,  // nested
+  };
+
+  DynamicStruct structure(*types["Samples"]);
+  structure.Unpack(bytes);
+
+  const DynamicArray& values = structure.Get<DynamicArray>("values");
+  const Span<const float> span = values.AsSpan<float>();
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(span.data()) % alignof(float), 0);
+  EXPECT_THAT(span, ElementsAre(1.0f, 2.0f, 3.0f, -4.0f));
+
+  // Spans alias the array.
+  structure.Get<DynamicArray>("values").AsSpan<float>()[1] = 5.0f;
+  EXPECT_EQ(span[1], 5.0f);
+  EXPECT_EQ(values.Get<float>(1), 5.0f);
+
+  EXPECT_THAT(structure.Get<DynamicArray>("nested").Get<DynamicArray>(1).AsSpan<int16_t>(),
+              ElementsAre(-4, -5, -6));
+  EXPECT_THROW(values.AsSpan<double>(), std::bad_variant_access);
+  EXPECT_THROW(structure.Get<DynamicArray>("nested").AsSpan<int16_t>(), std::bad_variant_access);
+}
+
+TEST(DynamicStruct, Pack) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  ASSERT_THAT(types.types(), Contains(Key("Bitfield4BytesTest")));
+
+  DynamicStruct structure(*types["Bitfield4BytesTest"]);
+  DynamicStruct& bitfield = structure.Get<DynamicStruct>("bitfield");
+  bitfield.Get<uint8_t>("field0") = 6;
+  bitfield.Get<uint8_t>("field1") = 27 | 0xE0;  // High bits beyond bit_size are dropped.
+  bitfield.Get<uint16_t>("field2") = 264;
+
+  uint8_t bytes[10];
+  memset(bytes, 0xFF, sizeof(bytes));
+  structure.Pack(bytes);
+  EXPECT_THAT(bytes, ElementsAre(0, 0, 0, 0, 0, 0, 0x00, 0x01, 0x08, 0xde));
+
+  DynamicStruct unpacked(*types["Bitfield4BytesTest"]);
+  unpacked.Unpack(bytes);
+  EXPECT_EQ(unpacked.Get<DynamicStruct>("bitfield").Get<uint8_t>("field1"), 27);
+}
+
+TEST(DynamicArray, Pack) {
+  DescriptorBuilder types = DescriptorBuilder::FromString(R"(
+Nested:
+  type: Message
+  fields:
+    - values: [[int16, 3], 2]
+)");
+
+  const uint8_t bytes[] = {0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0xff, 0xfc, 0xff, 0xfb, 0xff, 0xfa};
+
+  DynamicArray array((*types["Nested"])["values"]->type());
+  array.Unpack(bytes);
+
+  uint8_t packed[sizeof(bytes)] = {};
+  array.Pack(packed);
+  EXPECT_THAT(packed, ElementsAreArray(bytes));
+}
+
+TEST(PackMessage, Header) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& primitive_test = *types["PrimitiveTest"];
+
+  DynamicStruct msg(primitive_test);
+  msg.Get<uint8_t>("uint8") = 0xAA;
+
+  std::vector<uint8_t> bytes(primitive_test.packed_size() + 1);
+  EXPECT_EQ(PackMessage(msg, bytes.data(), primitive_test.packed_size() - 1), 0);
+  ASSERT_EQ(PackMessage(msg, bytes.data(), bytes.size()), primitive_test.packed_size());
+  EXPECT_THAT(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 7),
+              ElementsAre(0x2A, 0x5A, 0x96, 0x0B, 0x00, 0x31, 0xAA));
+
+  // The header is filled in the output only.
+  EXPECT_EQ(msg.Get<DynamicStruct>("ss_header").Get<uint32_t>("uid"), 0);
+
+  const auto [unpacked, status] = UnpackMessage(bytes.data(), primitive_test.packed_size(), types);
+  EXPECT_EQ(status, UnpackStatus::kSuccess);
+
+  DynamicStruct not_msg(*types["ArrayElem"]);
+  EXPECT_THROW(PackMessage(not_msg, bytes.data(), bytes.size()), std::runtime_error);
+}
+
+// Counts allocations passed on to the default resource.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  int allocations = 0;
+  int deallocations = 0;
+
+ private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    ++allocations;
+    return std::pmr::get_default_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    ++deallocations;
+    std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(DynamicStruct, MemoryResource) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  CountingResource resource;
+  {
+    DynamicStruct structure(*types["ArrayTest"], &resource);
+    EXPECT_EQ(resource.allocations, 1);
+
+    DynamicStruct copy(structure, &resource);
+    DynamicStruct default_copy(structure);
+    EXPECT_EQ(resource.allocations, 2);
+
+    // Moves take the buffer and its resource along.
+    DynamicStruct moved = std::move(copy);
+    EXPECT_EQ(resource.allocations, 2);
+
+    // The first access to a nested value allocates the handles for its level, once.
+    DynamicArray array(structure.Get<DynamicArray>("array_2d"), &resource);
+    structure.Get<DynamicArray>("array_1d");
+    EXPECT_EQ(resource.allocations, 4);
+    EXPECT_EQ(resource.deallocations, 0);
+
+    // Moves do not throw, so growing a vector moves its values rather than copying them out of
+    // their resource.
+    std::vector<DynamicStruct> values;
+    for (int i = 0; i < 5; ++i) values.emplace_back(*types["ArrayTest"], &resource);
+    EXPECT_EQ(resource.allocations, 9);
+  }
+  EXPECT_EQ(resource.deallocations, 9);
+}
+
+TEST(UnpackMessage, MemoryResource) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  std::fstream file{"test/test_data.bin", std::ios_base::in | std::ios_base::binary};
+  ASSERT_TRUE(file);
+  std::vector<uint8_t> bytes(std::istreambuf_iterator<char>(file), {});
+
+  // Message buffers come from the arena, which throws std::bad_alloc rather than fall back.
+  uint8_t arena[1024];
+  std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena),
+                                               std::pmr::null_memory_resource());
+
+  std::vector<DynamicStruct> msgs;
+  for (size_t offset = 0; offset < bytes.size();) {
+    const size_t len = UnpackBe<uint16_t>(bytes.data() + offset + 4);
+    auto [msg, status] = UnpackMessage(bytes.data() + offset, len, types, &resource);
+    ASSERT_EQ(status, UnpackStatus::kSuccess);
+    msgs.push_back(std::move(*msg));
+    offset += len;
+  }
+
+  ASSERT_EQ(msgs.size(), 4);
+  EXPECT_EQ(msgs[1].Get<int16_t>("enumeration"), 128);
+  EXPECT_EQ(msgs[2].Get<uint64_t>("uint64"), 0x0807060504030201);
+}
+
 TEST(UnpackMessage, LenError) {
   const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
   {
@@ -507,3 +904,72 @@ TEST(DynamicMessages, EndToEnd) {
               5);
   }
 }
+
+TEST(DynamicMessages, RoundTrip) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  std::fstream file{"test/test_data.bin", std::ios_base::in | std::ios_base::binary};
+  ASSERT_TRUE(file);
+
+  std::vector<uint8_t> buf(1024);
+  std::vector<uint8_t> packed(1024);
+  for (const char *name : {"Bitfield4BytesTest", "Enum2BytesTest", "PrimitiveTest", "ArrayTest"}) {
+    file.read(reinterpret_cast<char *>(buf.data()), types[name]->packed_size());
+    ASSERT_TRUE(file);
+
+    const auto [msg, status] = UnpackMessage(buf.data(), file.gcount(), types);
+    ASSERT_EQ(status, UnpackStatus::kSuccess);
+
+    // Byte for byte what the generated library packed.
+    SCOPED_TRACE(name);
+    ASSERT_EQ(PackMessage(*msg, packed.data(), packed.size()), file.gcount());
+    EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + file.gcount(), packed.begin()));
+  }
+}
+
+// A temporary DescriptorBuilder would dangle; an owning pointer is kept alive by the decoder.
+static_assert(!std::is_constructible_v<MessageDecoder<DescriptorBuilder>, DescriptorBuilder>);
+static_assert(std::is_constructible_v<MessageDecoder<DescriptorBuilder>,
+                                      std::shared_ptr<const DescriptorBuilder>>);
+
+TEST(MessageDecoder, ReusesMessages) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  std::fstream file{"test/test_data.bin", std::ios_base::in | std::ios_base::binary};
+  ASSERT_TRUE(file);
+  std::vector<uint8_t> bytes(std::istreambuf_iterator<char>(file), {});
+
+  CountingResource resource;
+  MessageDecoder decoder(types, &resource);
+
+  std::vector<DynamicStruct *> first_pass;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t offset = 0, i = 0; offset < bytes.size(); ++i) {
+      const size_t len = UnpackBe<uint16_t>(bytes.data() + offset + 4);
+      const auto [msg, status] = decoder.Unpack(bytes.data() + offset, len);
+      ASSERT_EQ(status, UnpackStatus::kSuccess);
+      ASSERT_NE(msg, nullptr);
+
+      if (pass == 0) {
+        first_pass.push_back(msg);
+      } else {
+        EXPECT_EQ(msg, first_pass[i]);
+      }
+      offset += len;
+    }
+    ASSERT_EQ(decoder.size(), 4);
+  }
+
+  // Re-decoding overwrites the cached message in place, without allocating.
+  const int allocations = resource.allocations;
+  first_pass[1]->Get<int16_t>("enumeration") = 5;
+  const auto [msg, status] = decoder.Unpack(bytes.data() + 10, 8);
+  EXPECT_EQ(msg, first_pass[1]);
+  EXPECT_EQ(msg->Get<int16_t>("enumeration"), 128);
+  EXPECT_EQ(resource.allocations, allocations);
+
+  const uint8_t bad_uid[7] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x07};
+  EXPECT_EQ(decoder.Unpack(bad_uid, sizeof(bad_uid)),
+            std::make_pair(static_cast<DynamicStruct *>(nullptr), UnpackStatus::kInvalidUid));
+  EXPECT_EQ(decoder.Unpack(bad_uid, 5).second, UnpackStatus::kInvalidLen);
+}
@@ -0,0 +1,241 @@
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/dynamic_view.h"
+#include "src/dynamic/type_descriptors.h"
+
+using namespace ss::dynamic;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+static void ExpectSame(const DynamicView& view, const DynamicStruct& structure);
+
+static void ExpectSame(const DynamicArrayView& view, const DynamicArray& array) {
+  ASSERT_EQ(view.size(), array.size());
+  const TypeDescriptor& elem = view.descriptor().array_elem_type();
+
+  for (size_t i = 0; i < view.size(); ++i) {
+    if (elem.IsArray()) {
+      ExpectSame(view.Get<DynamicArrayView>(i), array.Get<DynamicArray>(i));
+    } else if (elem.IsStruct() || elem.IsBitfield()) {
+      ExpectSame(view.Get<DynamicView>(i), array.Get<DynamicStruct>(i));
+    } else {
+      EXPECT_EQ(view.Convert<double>(i), array.Convert<double>(i));
+    }
+  }
+}
+
+static void ExpectSame(const DynamicView& view, const DynamicStruct& structure) {
+  for (const FieldDescriptor *field : view.descriptor().struct_fields()) {
+    const TypeDescriptor& type = field->type();
+    if (type.IsArray()) {
+      ExpectSame(view.Get<DynamicArrayView>(*field), structure.Get<DynamicArray>(*field));
+    } else if (type.IsStruct() || type.IsBitfield()) {
+      ExpectSame(view.Get<DynamicView>(*field), structure.Get<DynamicStruct>(*field));
+    } else {
+      EXPECT_EQ(view.Convert<double>(*field), structure.Convert<double>(*field)) << field->name();
+    }
+  }
+}
+
+TEST(DynamicView, Primitive) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& primitive_test = *types["PrimitiveTest"];
+
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01,  // uid
+      0x02, 0x01,  // len, 4
+      0x01,  // uint8, 5
+      0x02, 0x01,  // uint16, 7
+      0x04, 0x03, 0x02, 0x01,  // uint32, 9
+      0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,  // uint64, 13
+      0x01,  // int8, 21
+      0x02, 0x01,  // int16, 22
+      0x04, 0x03, 0x02, 0x01,  // int32, 24
+      0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,  // int64, 28
+      0x01,  // bool, 36
+      0x40, 0x49, 0x0f, 0xda,  // float, 37
+      0x40, 0x09, 0x21, 0xFB, 0x4D, 0x12, 0xD8, 0x4A,  // double, 41
+  };
+
+  const DynamicView view(bytes, primitive_test);
+  EXPECT_EQ(view.Get<DynamicView>("ss_header").Get<uint32_t>("uid"), 0x04030201);
+  EXPECT_EQ(view.Get<DynamicView>("ss_header").Get<uint16_t>("len"), 0x0201);
+  EXPECT_EQ(view.Get<uint8_t>("uint8"), 0x01);
+  EXPECT_EQ(view.Get<uint16_t>("uint16"), 0x0201);
+  EXPECT_EQ(view.Get<uint32_t>("uint32"), 0x04030201);
+  EXPECT_EQ(view.Get<uint64_t>("uint64"), 0x0807060504030201);
+  EXPECT_EQ(view.Get<int8_t>("int8"), 0x01);
+  EXPECT_EQ(view.Get<int16_t>("int16"), 0x0201);
+  EXPECT_EQ(view.Get<int32_t>("int32"), 0x04030201);
+  EXPECT_EQ(view.Get<int64_t>("int64"), 0x0807060504030201);
+  EXPECT_EQ(view.Get<bool>("boolean"), true);
+  EXPECT_FLOAT_EQ(view.Get<float>("float_type"), 3.1415926f);
+  EXPECT_DOUBLE_EQ(view.Get<double>("double_type"), 3.1415926);
+
+  EXPECT_EQ(view.Get<DynamicView>("ss_header").Convert<uint8_t>("uid"), 0x01);
+  EXPECT_EQ(view.Convert<uint8_t>("uint16"), 0x01);
+  EXPECT_EQ(view.Convert<uint8_t>("double_type"), 3);
+
+  EXPECT_THROW(view.Get<uint32_t>("uint16"), std::bad_variant_access);
+  EXPECT_THROW(view.Get<DynamicView>("uint16"), std::bad_variant_access);
+  EXPECT_THROW(view.Get<uint32_t>("ss_header"), std::bad_variant_access);
+  EXPECT_THROW(view.Convert<uint32_t>("ss_header"), std::bad_variant_access);
+}
+
+TEST(DynamicView, GetConvertIf) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& primitive_test = *types["PrimitiveTest"];
+
+  std::vector<uint8_t> bytes(primitive_test.packed_size());
+  bytes[6] = 1;
+  const DynamicView view(bytes.data(), primitive_test);
+
+  EXPECT_EQ(view.GetIf<uint8_t>("uint9"), std::nullopt);
+  EXPECT_EQ(view.GetIf<uint8_t>("uint8"), 1);
+  EXPECT_EQ(view.GetIf<DynamicView>("ss_header")->data(), bytes.data());
+  EXPECT_EQ(view.ConvertIf<float>("uint9"), std::nullopt);
+  EXPECT_FLOAT_EQ(*view.ConvertIf<float>("uint8"), 1.0f);
+
+  // Fields from another type are not found.
+  const FieldDescriptor& other_field = *(*types["ArrayElem"])["field0"];
+  EXPECT_EQ(view.GetIf<bool>(other_field), std::nullopt);
+  EXPECT_EQ(view.ConvertIf<int>(other_field), std::nullopt);
+  EXPECT_THROW(view.Get<bool>(other_field), std::out_of_range);
+}
+
+TEST(DynamicView, UnknownField) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& primitive_test = *types["PrimitiveTest"];
+
+  std::vector<uint8_t> bytes(primitive_test.packed_size());
+  const DynamicView view(bytes.data(), primitive_test);
+
+  EXPECT_THROW(view.Get<uint8_t>("uint9"), std::out_of_range);
+  EXPECT_THROW(view.Get<DynamicView>("header"), std::out_of_range);
+  EXPECT_THROW(view.Convert<float>("uint9"), std::out_of_range);
+}
+
+TEST(DynamicView, Bitfield) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x01, 0x08, 0xde,
+  };
+
+  const DynamicView view(bytes, *types["Bitfield4BytesTest"]);
+  const DynamicView bitfield = view.Get<DynamicView>("bitfield");
+  EXPECT_EQ(bitfield.Get<uint8_t>("field0"), 6);
+  EXPECT_EQ(bitfield.Get<uint8_t>("field1"), 27);
+  EXPECT_EQ(bitfield.Get<uint16_t>("field2"), 264);
+  EXPECT_EQ(bitfield.Convert<int>("field2"), 264);
+  EXPECT_THROW(bitfield.Get<uint16_t>("field0"), std::bad_variant_access);
+}
+
+TEST(DynamicView, Array) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& array_test = *types["ArrayTest"];
+
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+      0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x02, 0x00, 0x00,
+      0x03, 0x00, 0x00, 0x04, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+      0x00, 0x00, 0x02, 0x00, 0x00, 0x03, 0x00, 0x00, 0x04, 0x00, 0x00, 0x05,
+  };
+
+  const DynamicView view(bytes, array_test);
+  const DynamicArrayView array_2d = view.Get<DynamicArrayView>("array_2d");
+  ASSERT_EQ(array_2d.size(), 2);
+  ASSERT_EQ(array_2d.Get<DynamicArrayView>(0).size(), 3);
+
+  EXPECT_EQ(view.Get<DynamicArrayView>("array_1d").Get<DynamicView>(2).Get<uint16_t>("field1"), 2);
+  EXPECT_EQ(array_2d.Get<DynamicArrayView>(1).Get<DynamicView>(1).Get<uint16_t>("field1"), 4);
+  EXPECT_EQ(view.Get<DynamicArrayView>("array_3d")
+                .Get<DynamicArrayView>(0)
+                .Get<DynamicArrayView>(1)
+                .Get<DynamicView>(2)
+                .Get<uint16_t>("field1"),
+            5);
+
+  EXPECT_THROW(array_2d.Get<DynamicView>(0), std::bad_variant_access);
+  EXPECT_THROW(array_2d.Convert<int>(0), std::bad_variant_access);
+}
+
+TEST(DynamicView, MatchesDynamicStruct) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  for (const auto& [name, type] : types.types()) {
+    if (!type->IsStruct()) continue;
+
+    // Bytes below 0x40 keep floats finite.
+    std::vector<uint8_t> bytes(type->packed_size());
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = (i * 7 + 3) % 0x40;
+
+    DynamicStruct structure(*type);
+    structure.Unpack(bytes.data());
+
+    SCOPED_TRACE(name);
+    ExpectSame(DynamicView(bytes.data(), *type), structure);
+  }
+}
+
+TEST(ViewMessage, Errors) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  {
+    const uint8_t bytes[5] = {};
+    auto [msg, status] = ViewMessage(bytes, sizeof(bytes), types);
+    EXPECT_EQ(status, UnpackStatus::kInvalidLen);
+    EXPECT_FALSE(msg);
+  }
+  {
+    const uint8_t bytes[7] = {0x2A, 0x5A, 0x96, 0x0B, 0x00, 0x07};
+    auto [msg, status] = ViewMessage(bytes, sizeof(bytes), types);
+    EXPECT_EQ(status, UnpackStatus::kInvalidLen);
+    EXPECT_FALSE(msg);
+  }
+  {
+    const uint8_t bytes[7] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x07};
+    auto [msg, status] = ViewMessage(bytes, sizeof(bytes), types);
+    EXPECT_EQ(status, UnpackStatus::kInvalidUid);
+    EXPECT_FALSE(msg);
+  }
+  {
+    const uint8_t bytes[49] = {0x2A, 0x5A, 0x96, 0x0B, 0x00, 0x31, 0xAA};
+    auto [msg, status] = ViewMessage(bytes, sizeof(bytes), types);
+    EXPECT_EQ(status, UnpackStatus::kSuccess);
+    ASSERT_TRUE(msg);
+    EXPECT_THAT(msg->descriptor(), Address(types["PrimitiveTest"]));
+    EXPECT_EQ(msg->Get<uint8_t>("uint8"), 0xAA);
+  }
+}
+
+TEST(ViewMessage, EndToEnd) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  std::fstream file{"test/test_data.bin", std::ios_base::in | std::ios_base::binary};
+  ASSERT_TRUE(file);
+
+  std::vector<char> buf(1024);
+  for (const char *name : {"Bitfield4BytesTest", "Enum2BytesTest", "PrimitiveTest"}) {
+    file.read(buf.data(), types[name]->packed_size());
+    ASSERT_TRUE(file);
+
+    const uint8_t *data = reinterpret_cast<uint8_t *>(buf.data());
+    const auto [view, view_status] = ViewMessage(data, file.gcount(), types);
+    const auto [msg, msg_status] = UnpackMessage(data, file.gcount(), types);
+    ASSERT_EQ(view_status, UnpackStatus::kSuccess);
+    ASSERT_EQ(msg_status, UnpackStatus::kSuccess);
+
+    SCOPED_TRACE(name);
+    ExpectSame(*view, *msg);
+  }
+}
@@ -0,0 +1,165 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/field_accessor.h"
+#include "src/dynamic/type_descriptors.h"
+
+using namespace ss::dynamic;
+using namespace testing;
+
+using PrimType = TypeDescriptor::PrimType;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+TEST(FieldAccessor, Primitive) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& primitive_test = *types["PrimitiveTest"];
+
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01,  // uid
+      0x02, 0x01,  // len, 4
+      0x01,  // uint8, 5
+      0x02, 0x01,  // uint16, 7
+      0x04, 0x03, 0x02, 0x01,  // uint32, 9
+      0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,  // uint64, 13
+      0xFF,  // int8, 21
+      0x02, 0x01,  // int16, 22
+      0x04, 0x03, 0x02, 0x01,  // int32, 24
+      0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,  // int64, 28
+      0x01,  // bool, 36
+      0x40, 0x49, 0x0f, 0xda,  // float, 37
+      0x40, 0x09, 0x21, 0xFB, 0x4D, 0x12, 0xD8, 0x4A,  // double, 41
+  };
+
+  const FieldAccessor uid = FieldAccessor::Compile(primitive_test, "ss_header.uid");
+  EXPECT_EQ(uid.offset(), 0);
+  EXPECT_EQ(uid.prim_type(), PrimType::kUint32);
+  EXPECT_EQ(uid.Get<uint32_t>(bytes), 0x04030201);
+
+  EXPECT_EQ(FieldAccessor::Compile(primitive_test, "ss_header.len").Get<uint16_t>(bytes), 0x0201);
+  EXPECT_EQ(FieldAccessor::Compile(primitive_test, "uint64").Get<uint64_t>(bytes),
+            0x0807060504030201);
+  EXPECT_EQ(FieldAccessor::Compile(primitive_test, "int8").Get<int8_t>(bytes), -1);
+  EXPECT_EQ(FieldAccessor::Compile(primitive_test, "int8").Convert<int32_t>(bytes), -1);
+  EXPECT_EQ(FieldAccessor::Compile(primitive_test, "boolean").Get<bool>(bytes), true);
+  EXPECT_FLOAT_EQ(FieldAccessor::Compile(primitive_test, "float_type").Get<float>(bytes),
+                  3.1415926f);
+  EXPECT_DOUBLE_EQ(FieldAccessor::Compile(primitive_test, "double_type").Get<double>(bytes),
+                   3.1415926);
+  EXPECT_EQ(FieldAccessor::Compile(primitive_test, "double_type").Convert<int>(bytes), 3);
+
+  EXPECT_THROW(FieldAccessor::Compile(primitive_test, "uint16").Get<uint32_t>(bytes),
+               std::bad_variant_access);
+}
+
+TEST(FieldAccessor, Bitfield) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& bitfield_test = *types["Bitfield4BytesTest"];
+
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x01, 0x08, 0xde,
+  };
+
+  const FieldAccessor field1 = FieldAccessor::Compile(bitfield_test, "bitfield.field1");
+  EXPECT_TRUE(field1.is_bitfield_field());
+  EXPECT_EQ(field1.offset(), 6);
+  EXPECT_EQ(field1.bit_offset(), 3);
+  EXPECT_EQ(field1.bit_mask(), 0x1F);
+
+  EXPECT_EQ(FieldAccessor::Compile(bitfield_test, "bitfield.field0").Get<uint8_t>(bytes), 6);
+  EXPECT_EQ(field1.Get<uint8_t>(bytes), 27);
+  EXPECT_EQ(FieldAccessor::Compile(bitfield_test, "bitfield.field2").Get<uint16_t>(bytes), 264);
+
+  // Whole bitfield reads the raw container.
+  EXPECT_EQ(FieldAccessor::Compile(bitfield_test, "bitfield").Get<uint32_t>(bytes), 0x000108de);
+}
+
+TEST(FieldAccessor, Enum) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const uint8_t bytes[] = {
+      0x04, 0x03, 0x02, 0x01, 0x02, 0x01, 0x00, 0x80,
+  };
+
+  const FieldAccessor enumeration =
+      FieldAccessor::Compile(*types["Enum2BytesTest"], "enumeration");
+  EXPECT_EQ(&enumeration.type(), types["Enum2Bytes"]);
+  EXPECT_EQ(enumeration.Get<int16_t>(bytes), 128);
+}
+
+TEST(FieldAccessor, MatchesDynamicStruct) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& array_test = *types["ArrayTest"];
+
+  std::vector<uint8_t> bytes(array_test.packed_size());
+  for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = i * 37 + 11;
+
+  DynamicStruct structure(array_test);
+  structure.Unpack(bytes.data());
+
+  const DynamicArray& array_1d = structure.Get<DynamicArray>("array_1d");
+  const DynamicArray& array_2d = structure.Get<DynamicArray>("array_2d");
+  const DynamicArray& array_3d = structure.Get<DynamicArray>("array_3d");
+
+  auto read = [&](const std::string& path) {
+    return FieldAccessor::Compile(array_test, path).Get<uint16_t>(bytes.data());
+  };
+
+  for (int i = 0; i < 3; ++i) {
+    const std::string index = "[" + std::to_string(i) + "]";
+    EXPECT_EQ(FieldAccessor::Compile(array_test, "array_1d" + index + ".field0")
+                  .Get<bool>(bytes.data()),
+              array_1d.Get<DynamicStruct>(i).Get<bool>("field0"));
+    EXPECT_EQ(read("array_1d" + index + ".field1"),
+              array_1d.Get<DynamicStruct>(i).Get<uint16_t>("field1"));
+
+    for (int j = 0; j < 2; ++j) {
+      const std::string index_2d = "[" + std::to_string(j) + "]" + index;
+      EXPECT_EQ(read("array_2d" + index_2d + ".field1"),
+                array_2d.Get<DynamicArray>(j).Get<DynamicStruct>(i).Get<uint16_t>("field1"));
+      EXPECT_EQ(read("array_3d[0]" + index_2d + ".field1"), array_3d.Get<DynamicArray>(0)
+                                                                .Get<DynamicArray>(j)
+                                                                .Get<DynamicStruct>(i)
+                                                                .Get<uint16_t>("field1"));
+    }
+  }
+
+  // Array roots take a leading index.
+  const TypeDescriptor& array_type = structure.Get<DynamicArray>("array_2d").descriptor();
+  EXPECT_EQ(FieldAccessor::Compile(array_type, "[1][2].field1").offset(), (3 + 2) * 3 + 1);
+}
+
+TEST(FieldAccessor, InvalidPath) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& array_test = *types["ArrayTest"];
+  const TypeDescriptor& bitfield_test = *types["Bitfield4BytesTest"];
+
+  for (const char *path : {
+           "",
+           "ss_header",
+           "array_1d",
+           "array_1d[0]",
+           "missing",
+           "array_1d[3].field1",
+           "array_1d[].field1",
+           "array_1d[x].field1",
+           "array_1d[0",
+           ".ss_header.uid",
+           "ss_header..uid",
+           "ss_header.uid.x",
+           "ss_header[0].uid",
+           "array_1d.field1",
+           "array_1d[0]field1",
+       }) {
+    EXPECT_THROW(FieldAccessor::Compile(array_test, path), std::runtime_error) << path;
+  }
+
+  EXPECT_THROW(FieldAccessor::Compile(bitfield_test, "bitfield.field0.x"), std::runtime_error);
+  EXPECT_THROW(FieldAccessor::Compile(bitfield_test, "bitfield.field0[0]"), std::runtime_error);
+}
@@ -0,0 +1,128 @@
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/filter.h"
+#include "src/dynamic/type_descriptors.h"
+#include "test/dynamic/test_messages.h"
+
+using namespace ss::dynamic;
+using namespace ss::dynamic::test;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+TEST(Filter, Primitives) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["PrimitiveTest"];
+  const std::vector<uint8_t> data = PrimitiveTestData(types, 51, true);
+
+  const auto matches = [&](const char *expr) {
+    return Filter::Compile(type, expr).Matches(data.data(), data.size());
+  };
+
+  EXPECT_TRUE(matches("int32 > 50 && boolean"));
+  EXPECT_FALSE(matches("int32 > 51 && boolean"));
+  EXPECT_TRUE(matches("int32>=51&&boolean"));
+  EXPECT_FALSE(matches("int32 > 50 && !boolean"));
+  EXPECT_TRUE(matches("int32 > 51 || boolean == true"));
+  EXPECT_TRUE(matches("!(int32 < 0 || !uint8)"));
+  EXPECT_TRUE(matches("50 < int32"));
+  EXPECT_TRUE(matches("int8 == -128 && int8 < uint8"));
+  EXPECT_TRUE(matches("float_type > 0.09 && float_type < 0.11 && double_type < -1e300"));
+  EXPECT_TRUE(matches("float_type > int8 || uint16 != 1233"));
+  EXPECT_TRUE(matches("uint64 == 18446744073709551615"));
+  EXPECT_TRUE(matches("uint64 > uint16 && uint64 > int8"));
+  EXPECT_TRUE(matches("ss_header.len == 49"));
+  EXPECT_TRUE(matches("int64 || false"));
+  EXPECT_TRUE(matches("1e3 > 999"));
+
+  std::string nested = "int32 > 50";
+  for (int i = 0; i < 20; ++i) nested = "(boolean && " + nested + " || int8 > 0)";
+  EXPECT_TRUE(matches(nested.c_str()));
+}
+
+TEST(Filter, Aggregates) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  DynamicStruct array(*types["ArrayTest"]);
+  array.Get<DynamicArray>("array_2d").Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>(
+      "field1") = 77;
+  const std::vector<uint8_t> array_data = Pack(array);
+  EXPECT_TRUE(Filter::Compile(*types["ArrayTest"], "array_2d[1][2].field1 == 77 && "
+                                                   "!array_1d[0].field0")
+                  .Matches(array_data.data(), array_data.size()));
+
+  DynamicStruct bitfield(*types["Bitfield4BytesTest"]);
+  bitfield.Get<DynamicStruct>("bitfield").Get<uint16_t>("field2") = 300;
+  const std::vector<uint8_t> bitfield_data = Pack(bitfield);
+  EXPECT_TRUE(Filter::Compile(*types["Bitfield4BytesTest"], "bitfield.field2 > 299")
+                  .Matches(bitfield_data.data(), bitfield_data.size()));
+
+  DynamicStruct enumeration(*types["Enum2BytesTest"]);
+  enumeration.Get<int16_t>("enumeration") = 100;
+  const std::vector<uint8_t> enum_data = Pack(enumeration);
+  for (const char *expr : {"enumeration == Value100", "Value99 < enumeration", "enumeration"}) {
+    EXPECT_TRUE(Filter::Compile(*types["Enum2BytesTest"], expr)
+                    .Matches(enum_data.data(), enum_data.size()))
+        << expr;
+  }
+}
+
+TEST(Filter, RejectsHeader) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const Filter filter = Filter::Compile(*types["PrimitiveTest"], "true");
+
+  std::vector<uint8_t> data = PrimitiveTestData(types, 0, false);
+  EXPECT_TRUE(filter.Matches(data.data(), data.size()));
+  EXPECT_FALSE(filter.Matches(data.data(), data.size() - 1));
+
+  data[3] ^= 1;
+  EXPECT_FALSE(filter.Matches(data.data(), data.size()));
+
+  const std::vector<uint8_t> other = Pack(DynamicStruct(*types["ArrayTest"]));
+  EXPECT_FALSE(filter.Matches(other.data(), other.size()));
+}
+
+TEST(Filter, Select) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const Filter filter = Filter::Compile(*types["PrimitiveTest"], "int32 > 50 && boolean");
+
+  std::vector<std::vector<uint8_t>> messages;
+  for (int i = 0; i < 10; ++i) messages.push_back(PrimitiveTestData(types, i * 10, i % 3 == 0));
+  messages.push_back(Pack(DynamicStruct(*types["ArrayTest"])));
+
+  std::vector<const uint8_t *> buffers;
+  std::vector<size_t> lens;
+  for (const std::vector<uint8_t>& message : messages) {
+    buffers.push_back(message.data());
+    lens.push_back(message.size());
+  }
+
+  std::vector<size_t> selected(messages.size());
+  selected.resize(filter.Select(buffers.data(), lens.data(), buffers.size(), selected.data()));
+  EXPECT_THAT(selected, ElementsAre(6, 9));
+}
+
+TEST(Filter, Invalid) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["PrimitiveTest"];
+
+  for (const char *expr :
+       {"", "int32 >", "int33 > 5", "(int32 > 5", "int32 > 5)", "int32 > 5 &&", "int32 5",
+        "(int32 > 5) == 1", "int32 == Value1", "Value1", "int32 > 1.5.5", "int32 # 5",
+        "ss_header > 5"}) {
+    EXPECT_THROW(Filter::Compile(type, expr), std::runtime_error) << expr;
+  }
+  EXPECT_THROW(Filter::Compile(*types["Enum2BytesTest"], "enumeration == Value1000"),
+               std::runtime_error);
+  EXPECT_THROW(Filter::Compile(*types["ArrayElem"], "field0"), std::runtime_error);
+
+  EXPECT_THROW(Filter::Compile(type, "int32 > 5 - 1"), std::runtime_error);
+}
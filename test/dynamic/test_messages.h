@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/type_descriptors.h"
+
+namespace ss {
+namespace dynamic {
+namespace test {
+
+// msg packed by PackMessage into a buffer of exactly its size.
+inline std::vector<uint8_t> Pack(const DynamicStruct& msg) {
+  std::vector<uint8_t> data(msg.descriptor().packed_size());
+  PackMessage(msg, data.data(), data.size());
+  return data;
+}
+
+// A packed PrimitiveTest of test/test_message_spec.yaml with every other field at or near the
+// limits of its type.
+inline std::vector<uint8_t> PrimitiveTestData(const DescriptorBuilder& types, int32_t int32 = 70000,
+                                              bool boolean = true) {
+  DynamicStruct msg(*types["PrimitiveTest"]);
+  msg.Get<uint8_t>("uint8") = 255;
+  msg.Get<uint16_t>("uint16") = 1234;
+  msg.Get<uint32_t>("uint32") = 4000000000;
+  msg.Get<uint64_t>("uint64") = std::numeric_limits<uint64_t>::max();
+  msg.Get<int8_t>("int8") = -128;
+  msg.Get<int16_t>("int16") = -2;
+  msg.Get<int32_t>("int32") = int32;
+  msg.Get<int64_t>("int64") = std::numeric_limits<int64_t>::min();
+  msg.Get<bool>("boolean") = boolean;
+  msg.Get<float>("float_type") = 0.1f;
+  msg.Get<double>("double_type") = -1.5e300;
+  return Pack(msg);
+}
+
+}  // namespace test
+}  // namespace dynamic
+}  // namespace ss
@@ -1,4 +1,6 @@
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -113,6 +115,35 @@ TEST(Unpack, BigEndian) {
   }
 }
 
+template <typename T>
+static void ExpectByteSwapRun(uint32_t count) {
+#ifdef SS_X86_64
+  std::vector<uint8_t> packed(count * sizeof(T));
+  for (size_t i = 0; i < packed.size(); ++i) packed[i] = static_cast<uint8_t>(i * 31 + 5);
+
+  std::vector<T> values(count);
+  const uint32_t num_swapped = ByteSwapRunSsse3<sizeof(T)>(
+      packed.data(), reinterpret_cast<uint8_t *>(values.data()), count);
+  EXPECT_EQ(num_swapped, count - count % (16 / sizeof(T)));
+  for (uint32_t i = 0; i < num_swapped; ++i) {
+    EXPECT_EQ(values[i], UnpackBe<T>(packed.data() + i * sizeof(T)));
+  }
+#endif
+}
+
+TEST(Unpack, ByteSwapRun) {
+#ifdef SS_X86_64
+  if (!ss::GetCpuFeatures().ssse3) GTEST_SKIP() << "No SSSE3.";
+#endif
+
+  // Whole vectors and a left over tail.
+  for (const uint32_t count : {0, 1, 7, 8, 9, 33}) {
+    ExpectByteSwapRun<uint16_t>(count);
+    ExpectByteSwapRun<int32_t>(count);
+    ExpectByteSwapRun<uint64_t>(count);
+  }
+}
+
 TEST(Pack, BitfieldField) {
   const uint8_t field0 = 13;
   const int8_t field1 = -2;
@@ -136,3 +167,12 @@ TEST(Unpack, BitfieldField) {
   EXPECT_EQ(UnpackBitfield<uint16_t>(packed, 22, 5), 3);
   EXPECT_EQ(UnpackBitfield<int16_t>(packed, 27, 5), -15);
 }
+
+TEST(Bits, ExtractDeposit) {
+  const uint64_t mask = BitfieldMask(8, 7);
+  EXPECT_EQ(mask, 0x7F00);
+  EXPECT_EQ(BitfieldMask(0, 64), ~uint64_t{0});
+
+  EXPECT_EQ(ExtractBits(0x88FFFE6F, mask, 8), 0x7E);
+  EXPECT_EQ(DepositBits(0xFE, mask, 8), 0x7E00);
+}
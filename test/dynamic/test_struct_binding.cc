@@ -0,0 +1,217 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/struct_binding.h"
+#include "src/dynamic/type_descriptors.h"
+#include "test/dynamic/test_messages.h"
+
+using namespace ss::dynamic;
+using namespace ss::dynamic::test;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+struct Primitives {
+  double double_type;
+  uint8_t uint8;
+  uint16_t uint16;
+  uint32_t uint32;
+  uint64_t uint64;
+  int32_t int32;
+  bool boolean;
+};
+
+TEST(StructBinding, Primitives) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["PrimitiveTest"];
+
+  DynamicStruct msg(type);
+  msg.Get<uint8_t>("uint8") = 200;
+  msg.Get<uint16_t>("uint16") = 0xBEEF;
+  msg.Get<uint32_t>("uint32") = 0xDEADBEEF;
+  msg.Get<uint64_t>("uint64") = 1ull << 40;
+  msg.Get<int8_t>("int8") = -3;
+  msg.Get<int32_t>("int32") = -100000;
+  msg.Get<bool>("boolean") = true;
+  msg.Get<double>("double_type") = 0.5;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  StructBinding<Primitives> binding;
+  binding.Bind("uint8", &Primitives::uint8)
+      .Bind("uint16", &Primitives::uint16)
+      .Bind("uint32", &Primitives::uint32)
+      .Bind("uint64", &Primitives::uint64)
+      .Bind("int32", &Primitives::int32)
+      .Bind("boolean", &Primitives::boolean)
+      .Bind("double_type", &Primitives::double_type);
+  const BoundPlan<Primitives> plan = binding.Compile(type);
+
+  Primitives value{};
+  ASSERT_EQ(plan.Unpack(data.data(), data.size(), &value), UnpackStatus::kSuccess);
+  EXPECT_EQ(value.uint8, 200);
+  EXPECT_EQ(value.uint16, 0xBEEF);
+  EXPECT_EQ(value.uint32, 0xDEADBEEF);
+  EXPECT_EQ(value.uint64, 1ull << 40);
+  EXPECT_EQ(value.int32, -100000);
+  EXPECT_TRUE(value.boolean);
+  EXPECT_EQ(value.double_type, 0.5);
+
+  // Round trip, with unbound fields left as they are.
+  std::vector<uint8_t> packed(data.size());
+  packed[type.struct_fields()[5]->offset()] = 0xFD;
+  plan.Pack(value, packed.data());
+  EXPECT_EQ(packed, data);
+
+  EXPECT_EQ(plan.Unpack(data.data(), data.size() - 1, &value), UnpackStatus::kInvalidLen);
+  std::vector<uint8_t> other_uid = data;
+  other_uid[0] ^= 1;
+  EXPECT_EQ(plan.Unpack(other_uid.data(), other_uid.size(), &value), UnpackStatus::kInvalidUid);
+}
+
+struct Elem {
+  uint16_t field1;
+  bool field0;
+};
+
+struct Arrays {
+  Elem array_1d[3];
+  std::array<std::array<Elem, 3>, 2> array_2d;
+};
+
+TEST(StructBinding, ArraysAndStructs) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["ArrayTest"];
+
+  DynamicStruct msg(type);
+  for (int i = 0; i < 3; ++i) {
+    DynamicStruct& elem = msg.Get<DynamicArray>("array_1d").Get<DynamicStruct>(i);
+    elem.Get<bool>("field0") = i == 1;
+    elem.Get<uint16_t>("field1") = 100 + i;
+  }
+  msg.Get<DynamicArray>("array_2d").Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>(
+      "field1") = 77;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  StructBinding<Elem> elem;
+  elem.Bind("field0", &Elem::field0).Bind("field1", &Elem::field1);
+  StructBinding<Arrays> binding;
+  binding.Bind("array_1d", &Arrays::array_1d, elem).Bind("array_2d", &Arrays::array_2d, elem);
+  const BoundPlan<Arrays> plan = binding.Compile(type);
+
+  Arrays value{};
+  plan.Unpack(data.data(), &value);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(value.array_1d[i].field0, i == 1);
+    EXPECT_EQ(value.array_1d[i].field1, 100 + i);
+  }
+  EXPECT_EQ(value.array_2d[1][2].field1, 77);
+  EXPECT_EQ(value.array_2d[0][2].field1, 0);
+
+  // array_3d is unbound.
+  std::vector<uint8_t> packed(data.size());
+  plan.Pack(value, packed.data());
+  EXPECT_EQ(packed, data);
+}
+
+enum class Color : int16_t {
+  kValue0,
+  kValue1,
+  kValue2,
+};
+
+struct Enumeration {
+  Color enumeration;
+};
+
+struct Bits {
+  uint16_t field2;
+  uint8_t field0;
+};
+
+struct Bitfield {
+  Bits bitfield;
+};
+
+TEST(StructBinding, EnumsAndBitfields) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  DynamicStruct enumeration(*types["Enum2BytesTest"]);
+  enumeration.Get<int16_t>("enumeration") = 2;
+  const std::vector<uint8_t> enum_data = Pack(enumeration);
+
+  StructBinding<Enumeration> enum_binding;
+  enum_binding.Bind("enumeration", &Enumeration::enumeration);
+  Enumeration enum_value{};
+  enum_binding.Compile(*types["Enum2BytesTest"]).Unpack(enum_data.data(), &enum_value);
+  EXPECT_EQ(enum_value.enumeration, Color::kValue2);
+
+  DynamicStruct msg(*types["Bitfield4BytesTest"]);
+  msg.Get<DynamicStruct>("bitfield").Get<uint8_t>("field0") = 5;
+  msg.Get<DynamicStruct>("bitfield").Get<uint8_t>("field1") = 31;
+  msg.Get<DynamicStruct>("bitfield").Get<uint16_t>("field2") = 300;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  StructBinding<Bits> bits;
+  bits.Bind("field0", &Bits::field0).Bind("field2", &Bits::field2);
+  StructBinding<Bitfield> binding;
+  binding.Bind("bitfield", &Bitfield::bitfield, bits);
+  const BoundPlan<Bitfield> plan = binding.Compile(*types["Bitfield4BytesTest"]);
+
+  // One group for the two bound fields.
+  ASSERT_EQ(plan.plan().size(), 2);
+  EXPECT_EQ(plan.plan().begin()->count, 2);
+
+  Bitfield value{};
+  plan.Unpack(data.data(), &value);
+  EXPECT_EQ(value.bitfield.field0, 5);
+  EXPECT_EQ(value.bitfield.field2, 300);
+
+  // The unbound field1 packs as zero.
+  std::vector<uint8_t> packed(data.size());
+  plan.Pack(value, packed.data());
+  const auto [unpacked_msg, status] = UnpackMessage(packed.data(), packed.size(), types);
+  ASSERT_EQ(status, UnpackStatus::kSuccess);
+  const DynamicStruct& unpacked = unpacked_msg->Get<DynamicStruct>("bitfield");
+  EXPECT_EQ(unpacked.Get<uint8_t>("field0"), 5);
+  EXPECT_EQ(unpacked.Get<uint8_t>("field1"), 0);
+  EXPECT_EQ(unpacked.Get<uint16_t>("field2"), 300);
+}
+
+struct Mismatched {
+  int16_t uint16;
+  uint8_t uint8;
+  std::array<Elem, 2> array_1d;
+};
+
+TEST(StructBinding, Invalid) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  StructBinding<Mismatched> wrong_type;
+  wrong_type.Bind("uint16", &Mismatched::uint16);
+  EXPECT_THROW(wrong_type.Compile(*types["PrimitiveTest"]), std::runtime_error);
+
+  StructBinding<Mismatched> unknown;
+  unknown.Bind("missing", &Mismatched::uint8);
+  EXPECT_THROW(unknown.Compile(*types["PrimitiveTest"]), std::runtime_error);
+
+  StructBinding<Mismatched> twice;
+  twice.Bind("uint8", &Mismatched::uint8).Bind("uint8", &Mismatched::uint8);
+  EXPECT_THROW(twice.Compile(*types["PrimitiveTest"]), std::runtime_error);
+
+  StructBinding<Elem> elem;
+  StructBinding<Mismatched> wrong_size;
+  wrong_size.Bind("array_1d", &Mismatched::array_1d, elem);
+  EXPECT_THROW(wrong_size.Compile(*types["ArrayTest"]), std::runtime_error);
+
+  StructBinding<Mismatched> not_struct;
+  EXPECT_THROW(not_struct.Compile(*types["uint8"]), std::runtime_error);
+  EXPECT_NO_THROW(not_struct.Compile(*types["PrimitiveTest"]));
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/text_exporter.h"
+#include "src/dynamic/type_descriptors.h"
+#include "test/dynamic/test_messages.h"
+
+using namespace ss::dynamic;
+using namespace ss::dynamic::test;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+class Output {
+ public:
+  TextExporter::Sink sink() {
+    return [this](const char *data, size_t size) {
+      text.append(data, size);
+      ++flushes;
+    };
+  }
+
+  std::string text;
+  int flushes = 0;
+};
+
+TEST(TextExporter, JsonLines) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  Output output;
+  TextExporter exporter(TextExporter::Format::kJsonLines, output.sink());
+
+  const std::vector<uint8_t> primitive = PrimitiveTestData(types);
+  exporter.Write(*types["PrimitiveTest"], primitive.data());
+
+  DynamicStruct bitfield(*types["Bitfield4BytesTest"]);
+  bitfield.Get<DynamicStruct>("bitfield").Get<uint8_t>("field0") = 5;
+  bitfield.Get<DynamicStruct>("bitfield").Get<uint16_t>("field2") = 300;
+  exporter.Write(*types["Bitfield4BytesTest"], Pack(bitfield).data());
+
+  DynamicStruct enumeration(*types["Enum2BytesTest"]);
+  enumeration.Get<int16_t>("enumeration") = 100;
+  exporter.Write(*types["Enum2BytesTest"], Pack(enumeration).data());
+  enumeration.Get<int16_t>("enumeration") = -3;
+  exporter.Write(*types["Enum2BytesTest"], Pack(enumeration).data());
+
+  EXPECT_TRUE(output.text.empty());
+  exporter.Flush();
+
+  const std::string primitive_uid = std::to_string(types["PrimitiveTest"]->uid());
+  const std::string bitfield_uid = std::to_string(types["Bitfield4BytesTest"]->uid());
+  const std::string enum_uid = std::to_string(types["Enum2BytesTest"]->uid());
+  EXPECT_EQ(output.text,
+            "{\"PrimitiveTest\":{\"ss_header\":{\"uid\":" + primitive_uid +
+                ",\"len\":49},\"uint8\":255,\"uint16\":1234,\"uint32\":4000000000,"
+                "\"uint64\":18446744073709551615,\"int8\":-128,\"int16\":-2,\"int32\":70000,"
+                "\"int64\":-9223372036854775808,\"boolean\":true,\"float_type\":0.1,"
+                "\"double_type\":-1.5e+300}}\n"
+                "{\"Bitfield4BytesTest\":{\"ss_header\":{\"uid\":" +
+                bitfield_uid +
+                ",\"len\":10},\"bitfield\":{\"field0\":5,\"field1\":0,\"field2\":300}}}\n"
+                "{\"Enum2BytesTest\":{\"ss_header\":{\"uid\":" +
+                enum_uid +
+                ",\"len\":8},\"enumeration\":\"Value100\"}}\n"
+                "{\"Enum2BytesTest\":{\"ss_header\":{\"uid\":" +
+                enum_uid + ",\"len\":8},\"enumeration\":-3}}\n");
+}
+
+TEST(TextExporter, JsonArrays) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  Output output;
+  TextExporter exporter(TextExporter::Format::kJsonLines, output.sink());
+
+  DynamicStruct alias(*types["AliasTest"]);
+  alias.Get<DynamicArray>("position").Get<float>(1) = 2;
+  alias.Get<DynamicArray>("position").Get<float>(2) = std::numeric_limits<float>::infinity();
+  alias.Get<DynamicStruct>("velocity").Get<float>("z") = -0.5;
+
+  exporter.Project(*types["AliasTest"], {"position", "velocity.z"});
+  exporter.Write(*types["AliasTest"], Pack(alias).data());
+  exporter.Flush();
+
+  EXPECT_EQ(output.text, "{\"AliasTest\":{\"position\":[0,2,null],\"velocity\":{\"z\":-0.5}}}\n");
+}
+
+TEST(TextExporter, Csv) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["ArrayTest"];
+
+  DynamicStruct msg(type);
+  msg.Get<DynamicArray>("array_2d").Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>(
+      "field1") = 77;
+  msg.Get<DynamicArray>("array_1d").Get<DynamicStruct>(0).Get<bool>("field0") = true;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  {
+    Output output;
+    TextExporter exporter(TextExporter::Format::kCsv, output.sink());
+    exporter.Project(type, {"array_1d.field0", "array_2d"});
+    exporter.Write(type, data.data());
+    exporter.Write(type, data.data());
+    exporter.Flush();
+
+    const std::string header =
+        "array_1d[0].field0,array_1d[1].field0,array_1d[2].field0,"
+        "array_2d[0][0].field0,array_2d[0][0].field1,array_2d[0][1].field0,array_2d[0][1].field1,"
+        "array_2d[0][2].field0,array_2d[0][2].field1,array_2d[1][0].field0,array_2d[1][0].field1,"
+        "array_2d[1][1].field0,array_2d[1][1].field1,array_2d[1][2].field0,array_2d[1][2].field1\n";
+    const std::string row = "true,false,false,false,0,false,0,false,0,false,0,false,0,false,77\n";
+    EXPECT_EQ(output.text, header + row + row);
+  }
+
+  {
+    Output output;
+    TextExporter exporter(TextExporter::Format::kCsv, output.sink());
+    exporter.Write(*types["Enum1BytesTest"], Pack(DynamicStruct(*types["Enum1BytesTest"])).data());
+    exporter.Flush();
+
+    EXPECT_EQ(output.text, "ss_header.uid,ss_header.len,enumeration\n" +
+                               std::to_string(types["Enum1BytesTest"]->uid()) + ",7,Value0\n");
+  }
+}
+
+TEST(TextExporter, Buffering) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const std::vector<uint8_t> data = PrimitiveTestData(types);
+
+  Output reference;
+  {
+    TextExporter exporter(TextExporter::Format::kJsonLines, reference.sink());
+    exporter.Write(*types["PrimitiveTest"], data.data());
+  }
+  ASSERT_EQ(reference.flushes, 1);
+
+  // Rows never straddle a flush, and a buffer smaller than one row grows.
+  Output output;
+  {
+    TextExporter exporter(TextExporter::Format::kJsonLines, output.sink(), 16);
+    for (int i = 0; i < 100; ++i) exporter.Write(*types["PrimitiveTest"], data.data());
+    EXPECT_EQ(output.flushes, 99);
+  }
+
+  std::string expected;
+  for (int i = 0; i < 100; ++i) expected += reference.text;
+  EXPECT_EQ(output.text, expected);
+}
+
+TEST(TextExporter, WriteMessage) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  Output output;
+  TextExporter exporter(TextExporter::Format::kJsonLines, output.sink());
+
+  std::vector<uint8_t> data = PrimitiveTestData(types);
+  EXPECT_EQ(exporter.WriteMessage(data.data(), data.size(), types), UnpackStatus::kSuccess);
+  EXPECT_EQ(exporter.WriteMessage(data.data(), data.size() - 1, types), UnpackStatus::kInvalidLen);
+  data[0] ^= 0xFF;
+  EXPECT_EQ(exporter.WriteMessage(data.data(), data.size(), types), UnpackStatus::kInvalidUid);
+  exporter.Flush();
+
+  EXPECT_EQ(std::count(output.text.begin(), output.text.end(), '\n'), 1);
+}
+
+TEST(TextExporter, InvalidProjection) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  TextExporter exporter(TextExporter::Format::kCsv, [](const char *, size_t) {});
+
+  EXPECT_THROW(exporter.Project(*types["ArrayTest"], {"array_1d[0]"}), std::runtime_error);
+  EXPECT_THROW(exporter.Project(*types["ArrayTest"], {"array_1d.field2"}), std::runtime_error);
+  EXPECT_THROW(exporter.Project(*types["ArrayTest"], {"array_1d.field0.x"}), std::runtime_error);
+  EXPECT_THROW(exporter.Project(*types["ArrayTest"], {"ss_header."}), std::runtime_error);
+  EXPECT_THROW(exporter.Write(*types["Enum1Bytes"], nullptr), std::runtime_error);
+  EXPECT_THROW(exporter.Write(*types["Bitfield4Bytes"], nullptr), std::runtime_error);
+
+  exporter.Project(*types["ArrayTest"], {"ss_header.uid"});
+  EXPECT_THROW(exporter.Project(*types["ArrayTest"], {"ss_header"}), std::runtime_error);
+}
@@ -0,0 +1,254 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/transcoder.h"
+#include "src/dynamic/type_descriptors.h"
+#include "test/dynamic/test_messages.h"
+
+using namespace ss::dynamic;
+using namespace ss::dynamic::test;
+using namespace testing;
+
+const std::string kOldSpec = R"(
+Color:
+  type: Enum
+  values:
+    - Red:
+    - Green:
+    - Blue:
+
+Flags:
+  type: Bitfield
+  fields:
+    - a: 3
+    - b: 5
+
+Point:
+  type: Struct
+  fields:
+    - x: int16
+    - y: int16
+
+Unchanged:
+  type: Message
+  fields:
+    - value: uint32
+    - point: Point
+
+Dropped:
+  type: Message
+  fields:
+    - value: uint8
+
+Sample:
+  type: Message
+  fields:
+    - count: uint8
+    - color: Color
+    - removed: uint32
+    - flags: Flags
+    - points: [Point, 3]
+    - scale: float
+    - id: uint32
+    - narrowed: int32
+)";
+
+const std::string kNewSpec = R"(
+Color:
+  type: Enum
+  values:
+    - Blue:
+    - Red:
+    - Yellow:
+
+Flags:
+  type: Bitfield
+  fields:
+    - b: 6
+    - c: 2
+    - a: 3
+
+Point:
+  type: Struct
+  fields:
+    - x: int32
+    - y: int16
+    - z: float
+
+Unchanged:
+  type: Message
+  fields:
+    - value: uint32
+    - point: Point
+
+Sample:
+  type: Message
+  fields:
+    - id: uint32
+    - count: uint16
+    - color: Color
+    - flags: Flags
+    - points: [Point, 2]
+    - added: uint8
+    - scale: double
+    - narrowed: int16
+)";
+
+TEST(Transcoder, Sample) {
+  const DescriptorBuilder old_types = DescriptorBuilder::FromString(kOldSpec);
+  const DescriptorBuilder new_types = DescriptorBuilder::FromString(kNewSpec);
+  const Transcoder transcoder(old_types, new_types);
+
+  DynamicStruct old_msg(*old_types["Sample"]);
+  old_msg.Get<uint8_t>("count") = 200;
+  old_msg.Get<int8_t>("color") = 1;
+  old_msg.Get<uint32_t>("removed") = 5;
+  old_msg.Get<DynamicStruct>("flags").Get<uint8_t>("a") = 6;
+  old_msg.Get<DynamicStruct>("flags").Get<uint8_t>("b") = 31;
+  for (int i = 0; i < 3; ++i) {
+    DynamicStruct& point = old_msg.Get<DynamicArray>("points").Get<DynamicStruct>(i);
+    point.Get<int16_t>("x") = -1000 * (i + 1);
+    point.Get<int16_t>("y") = i;
+  }
+  old_msg.Get<float>("scale") = 0.1f;
+  old_msg.Get<uint32_t>("id") = 0xDEADBEEF;
+  old_msg.Get<int32_t>("narrowed") = 7;
+  const std::vector<uint8_t> old_data = Pack(old_msg);
+
+  std::vector<uint8_t> new_data(new_types["Sample"]->packed_size(), 0xAA);
+  ASSERT_EQ(transcoder.Transcode(old_data.data(), old_data.size(), new_data.data(),
+                                 new_data.size()),
+            new_data.size());
+
+  auto [new_msg, status] = UnpackMessage(new_data.data(), new_data.size(), new_types);
+  ASSERT_EQ(status, UnpackStatus::kSuccess);
+  EXPECT_EQ(new_msg->Get<uint32_t>("id"), 0xDEADBEEF);
+  EXPECT_EQ(new_msg->Get<uint16_t>("count"), 200);
+  EXPECT_EQ(new_msg->Get<uint8_t>("added"), 0);
+  EXPECT_EQ(new_msg->Get<double>("scale"), 0.1f);
+  EXPECT_EQ(new_msg->Get<int16_t>("narrowed"), 0);
+
+  // Green has no new value.
+  EXPECT_EQ(new_msg->Get<int8_t>("color"), 0);
+
+  const DynamicStruct& flags = new_msg->Get<DynamicStruct>("flags");
+  EXPECT_EQ(flags.Get<uint8_t>("a"), 6);
+  EXPECT_EQ(flags.Get<uint8_t>("b"), 31);
+  EXPECT_EQ(flags.Get<uint8_t>("c"), 0);
+
+  const DynamicArray& points = new_msg->Get<DynamicArray>("points");
+  ASSERT_EQ(points.size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    const DynamicStruct& point = points.Get<DynamicStruct>(i);
+    EXPECT_EQ(point.Get<int32_t>("x"), -1000 * (i + 1));
+    EXPECT_EQ(point.Get<int16_t>("y"), i);
+    EXPECT_EQ(point.Get<float>("z"), 0);
+  }
+
+  // Enum values are mapped by name.
+  old_msg.Get<int8_t>("color") = 0;
+  const std::vector<uint8_t> red = Pack(old_msg);
+  transcoder.Transcode(red.data(), red.size(), new_data.data(), new_data.size());
+  EXPECT_EQ(UnpackMessage(new_data.data(), new_data.size(), new_types).first->Get<int8_t>("color"),
+            1);
+
+  old_msg.Get<int8_t>("color") = 2;
+  const std::vector<uint8_t> blue = Pack(old_msg);
+  transcoder.Transcode(blue.data(), blue.size(), new_data.data(), new_data.size());
+  EXPECT_EQ(UnpackMessage(new_data.data(), new_data.size(), new_types).first->Get<int8_t>("color"),
+            0);
+}
+
+static std::string EnumSpec(int num_level_values, int num_wide_values) {
+  std::string spec = "Level:\n  type: Enum\n  values:\n";
+  for (int i = 0; i < num_level_values; ++i) {
+    spec += "    - Level" + std::to_string(i) + ":\n";
+  }
+  spec += "Wide:\n  type: Enum\n  values:\n";
+  for (int i = 0; i < num_wide_values; ++i) {
+    spec += "    - Wide" + std::to_string(i) + ":\n";
+  }
+  spec += "Levels:\n  type: Message\n  fields:\n    - level: Level\n    - wide: Wide\n";
+  return spec;
+}
+
+TEST(Transcoder, AppendedEnum) {
+  // Level keeps its size, Wide grows from int8 to int16.
+  const DescriptorBuilder old_types = DescriptorBuilder::FromString(EnumSpec(3, 120));
+  const DescriptorBuilder new_types = DescriptorBuilder::FromString(EnumSpec(5, 200));
+  ASSERT_EQ(old_types["Wide"]->prim_type(), TypeDescriptor::PrimType::kInt8);
+  ASSERT_EQ(new_types["Wide"]->prim_type(), TypeDescriptor::PrimType::kInt16);
+  const Transcoder transcoder(old_types, new_types);
+
+  // Numbers are unchanged, so no lookup table is needed.
+  const impl::TranscodePlan *plan = transcoder.plan(old_types["Levels"]->uid());
+  ASSERT_NE(plan, nullptr);
+  EXPECT_THAT(plan->ops,
+              Each(Field(&impl::TranscodeOp::kind, Ne(impl::TranscodeOp::Kind::kEnum))));
+  EXPECT_THAT(plan->enum_values, IsEmpty());
+
+  DynamicStruct old_msg(*old_types["Levels"]);
+  old_msg.Get<int8_t>("level") = 2;
+  old_msg.Get<int8_t>("wide") = 119;
+  const std::vector<uint8_t> old_data = Pack(old_msg);
+
+  std::vector<uint8_t> new_data(new_types["Levels"]->packed_size());
+  ASSERT_EQ(transcoder.Transcode(old_data.data(), old_data.size(), new_data.data(),
+                                 new_data.size()),
+            new_data.size());
+
+  auto [new_msg, status] = UnpackMessage(new_data.data(), new_data.size(), new_types);
+  ASSERT_EQ(status, UnpackStatus::kSuccess);
+  EXPECT_EQ(new_msg->Get<int8_t>("level"), 2);
+  EXPECT_EQ(new_msg->Get<int16_t>("wide"), 119);
+}
+
+TEST(Transcoder, Plans) {
+  const DescriptorBuilder old_types = DescriptorBuilder::FromString(kOldSpec);
+  const DescriptorBuilder new_types = DescriptorBuilder::FromString(kNewSpec);
+  const Transcoder transcoder(old_types, new_types);
+
+  EXPECT_EQ(transcoder.plan(old_types["Dropped"]->uid()), nullptr);
+
+  // Point gained a field, which changes Unchanged's UID too.
+  ASSERT_NE(old_types["Unchanged"]->uid(), new_types["Unchanged"]->uid());
+  const impl::TranscodePlan *unchanged = transcoder.plan(old_types["Unchanged"]->uid());
+  ASSERT_NE(unchanged, nullptr);
+  EXPECT_EQ(unchanged->to, new_types["Unchanged"]);
+  EXPECT_TRUE(unchanged->zero);
+
+  // Unchanged messages are a single copy.
+  const DescriptorBuilder same_types = DescriptorBuilder::FromString(kOldSpec);
+  const Transcoder identity(old_types, same_types);
+  const impl::TranscodePlan *sample = identity.plan(old_types["Sample"]->uid());
+  ASSERT_NE(sample, nullptr);
+  ASSERT_EQ(sample->ops.size(), 1);
+  EXPECT_EQ(sample->ops[0].kind, impl::TranscodeOp::Kind::kCopy);
+  EXPECT_EQ(sample->ops[0].size, old_types["Sample"]->packed_size());
+  EXPECT_FALSE(sample->zero);
+}
+
+TEST(Transcoder, Invalid) {
+  const DescriptorBuilder old_types = DescriptorBuilder::FromString(kOldSpec);
+  const DescriptorBuilder new_types = DescriptorBuilder::FromString(kNewSpec);
+  const Transcoder transcoder(old_types, new_types);
+
+  std::vector<uint8_t> data = Pack(DynamicStruct(*old_types["Sample"]));
+  std::vector<uint8_t> out(new_types["Sample"]->packed_size());
+
+  EXPECT_EQ(transcoder.Transcode(data.data(), data.size(), out.data(), out.size() - 1), 0);
+  EXPECT_EQ(transcoder.Transcode(data.data(), data.size() - 1, out.data(), out.size()), 0);
+  EXPECT_EQ(transcoder.Transcode(data.data(), 4, out.data(), out.size()), 0);
+
+  const std::vector<uint8_t> dropped = Pack(DynamicStruct(*old_types["Dropped"]));
+  EXPECT_EQ(transcoder.Transcode(dropped.data(), dropped.size(), out.data(), out.size()), 0);
+
+  data[0] ^= 1;
+  EXPECT_EQ(transcoder.Transcode(data.data(), data.size(), out.data(), out.size()), 0);
+}
@@ -1,10 +1,12 @@
 #include <fstream>
+#include <random>
 #include <sstream>
 #include <string>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "src/crc32.h"
 #include "src/dynamic/type_descriptors.h"
 
 using namespace ss::dynamic;
@@ -17,7 +19,7 @@ const std::string kYamlFile = "test/test_message_spec.yaml";
 
 static Matcher<TypeDescriptor::FieldList> FieldDescriptorMatcher(
     std::vector<std::pair<std::string, const TypeDescriptor *>> fields) {
-  std::vector<Matcher<std::unique_ptr<const FieldDescriptor>>> field_matcher;
+  std::vector<Matcher<DescriptorPtr<const FieldDescriptor>>> field_matcher;
   for (const auto& [name, type] : fields) {
     field_matcher.push_back(
         Pointee(AllOf(Property("name", &FieldDescriptor::name, Eq(name)),
@@ -392,6 +394,31 @@ TEST(TypeDescriptor, FieldLookup) {
   EXPECT_THAT((*types["PrimitiveTest"])["int64"]->type(), Address(types["int64"]));
 }
 
+TEST(TypeDescriptor, FieldLookupMissing) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  ASSERT_THAT(types.types(), IsSupersetOf({Key("Bitfield4Bytes"), Key("PrimitiveTest")}));
+
+  EXPECT_EQ((*types["Bitfield4Bytes"])["field3"], nullptr);
+  EXPECT_EQ((*types["PrimitiveTest"])["int"], nullptr);
+  EXPECT_EQ((*types["PrimitiveTest"])[""], nullptr);
+}
+
+TEST(TypeDescriptor, FieldOrdinal) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+
+  for (const char *name : {"PrimitiveTest", "ArrayTest", "Bitfield4Bytes"}) {
+    ASSERT_THAT(types.types(), Contains(Key(name)));
+
+    const TypeDescriptor& type = *types[name];
+    const TypeDescriptor::FieldList& fields = type.struct_fields();
+    for (size_t i = 0; i < fields.size(); ++i) {
+      EXPECT_EQ(fields[i]->ordinal(), i);
+      EXPECT_EQ(type[fields[i]->name()], fields[i].get());
+    }
+  }
+}
+
 TEST(TypeDescriptor, FieldOffset) {
   DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
 
@@ -424,3 +451,270 @@ TEST(TypeDescriptor, FieldOffset) {
   EXPECT_EQ((*types["Bitfield4Bytes"])["field2"]->bit_offset(), 8);
   EXPECT_EQ((*types["Bitfield4Bytes"])["field2"]->bit_size(), 9);
 }
+
+static std::string WideSpec(int num_values, int num_fields) {
+  std::string spec = "WideEnum:\n  type: Enum\n  values:\n";
+  for (int i = 0; i < num_values; ++i) {
+    spec += "    - Value" + std::to_string(i) + ":\n";
+  }
+
+  spec += "WideMessage:\n  type: Message\n  fields:\n";
+  for (int i = 0; i < num_fields; ++i) {
+    spec += "    - field" + std::to_string(i) + ": uint32\n";
+  }
+
+  return spec;
+}
+
+TEST(DescriptorBuilder, WideSpec) {
+  DescriptorBuilder types = DescriptorBuilder::FromString(WideSpec(2000, 500));
+
+  const TypeDescriptor& wide_enum = *types["WideEnum"];
+  EXPECT_EQ(wide_enum.enum_values().size(), 2000);
+  EXPECT_EQ(wide_enum.prim_type(), PrimType::kInt16);
+  EXPECT_EQ(wide_enum.packed_size(), 2);
+
+  std::vector<uint32_t> value_uids;
+  for (int i = 0; i < 2000; ++i) {
+    const std::string name = "Value" + std::to_string(i);
+    value_uids.push_back(ss::EnumValueHash(name.c_str(), i));
+  }
+  EXPECT_EQ(wide_enum.uid(), ss::EnumHash("WideEnum", value_uids.data(), value_uids.size()));
+
+  const TypeDescriptor& wide_msg = *types["WideMessage"];
+  ASSERT_EQ(wide_msg.struct_fields().size(), 501);
+  EXPECT_EQ(wide_msg.packed_size(), 6 + 4 * 500);
+  EXPECT_EQ(wide_msg.struct_fields().back()->offset(), 6 + 4 * 499);
+  EXPECT_EQ(types.LookupMsgFromUid(wide_msg.uid()), &wide_msg);
+}
+
+const std::string kBlobFile = "test/test_message_spec.ssdb";
+
+static std::vector<uint8_t> ReadFile(const std::string& filename) {
+  std::ifstream ifs(filename, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)),
+                              std::istreambuf_iterator<char>());
+}
+
+static void ExpectSameTypes(const DescriptorBuilder& expected, const DescriptorBuilder& actual) {
+  ASSERT_EQ(actual.types().size(), expected.types().size());
+
+  for (const auto& [name, type] : expected.types()) {
+    SCOPED_TRACE(name);
+    const TypeDescriptor *other = actual[name];
+    ASSERT_NE(other, nullptr);
+
+    EXPECT_EQ(other->type(), type->type());
+    EXPECT_EQ(other->uid(), type->uid());
+    EXPECT_EQ(other->packed_size(), type->packed_size());
+
+    if (type->IsStruct()) {
+      ASSERT_EQ(other->struct_fields().size(), type->struct_fields().size());
+      for (size_t i = 0; i < type->struct_fields().size(); ++i) {
+        EXPECT_EQ(other->struct_fields()[i]->name(), type->struct_fields()[i]->name());
+        EXPECT_EQ(other->struct_fields()[i]->offset(), type->struct_fields()[i]->offset());
+      }
+    }
+  }
+}
+
+TEST(DescriptorBlob, RoundTrip) {
+  const DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const std::vector<uint8_t> blob = types.ToBlob();
+  const DescriptorBuilder loaded = DescriptorBuilder::FromBlob(blob.data(), blob.size());
+
+  ExpectSameTypes(types, loaded);
+  EXPECT_EQ(loaded.LookupMsgFromUid(710579723), loaded["PrimitiveTest"]);
+  EXPECT_EQ(loaded.ToBlob(), blob);
+}
+
+TEST(DescriptorBlob, MatchesGenerator) {
+  const std::vector<uint8_t> blob = ReadFile(kBlobFile);
+  ASSERT_FALSE(blob.empty());
+
+  EXPECT_EQ(DescriptorBuilder::FromFile(kYamlFile).ToBlob(), blob);
+  ExpectSameTypes(DescriptorBuilder::FromFile(kYamlFile),
+                  DescriptorBuilder::FromBlob(blob.data(), blob.size()));
+}
+
+TEST(DescriptorBlob, TrailingData) {
+  std::vector<uint8_t> blob = DescriptorBuilder::FromFile(kYamlFile).ToBlob();
+  const size_t len = blob.size();
+  blob.insert(blob.end(), {'S', 's', 'L', 'o', 'g'});
+
+  const DescriptorBuilder loaded = DescriptorBuilder::FromBlob(blob.data(), blob.size());
+  blob.resize(len);
+  EXPECT_EQ(loaded.ToBlob(), blob);
+}
+
+TEST(DescriptorBlob, Invalid) {
+  const std::vector<uint8_t> blob = DescriptorBuilder::FromFile(kYamlFile).ToBlob();
+
+  EXPECT_THROW(DescriptorBuilder::FromBlob(blob.data(), 0), std::runtime_error);
+  EXPECT_THROW(DescriptorBuilder::FromBlob(blob.data(), blob.size() - 1), std::runtime_error);
+
+  std::vector<uint8_t> bad_magic = blob;
+  bad_magic[0] = 'X';
+  EXPECT_THROW(DescriptorBuilder::FromBlob(bad_magic.data(), bad_magic.size()),
+               std::runtime_error);
+
+  // Flip a bit in every byte past the header and check it is always caught.
+  for (size_t i = 4; i < blob.size(); ++i) {
+    std::vector<uint8_t> corrupt = blob;
+    corrupt[i] ^= 0x10;
+    EXPECT_THROW(DescriptorBuilder::FromBlob(corrupt.data(), corrupt.size()), std::runtime_error)
+        << "byte " << i;
+  }
+}
+
+// Wraps type records in a valid header and CRC, so only the records themselves are checked.
+static std::vector<uint8_t> SealBlob(uint32_t num_types, const std::vector<uint8_t>& records) {
+  const uint32_t total_len = 16 + records.size() + 4;
+  std::vector<uint8_t> blob = {'S', 'S', 'D', 'B', 0, 1, 0, 0};
+  for (uint32_t value : {num_types, total_len}) {
+    for (int shift = 24; shift >= 0; shift -= 8) blob.push_back(value >> shift);
+  }
+  blob.insert(blob.end(), records.begin(), records.end());
+  const uint32_t crc = ss::GetCrc32(blob.data(), blob.size());
+  for (int shift = 24; shift >= 0; shift -= 8) blob.push_back(crc >> shift);
+  return blob;
+}
+
+TEST(DescriptorBlob, Garbage) {
+  auto load = [](const std::vector<uint8_t>& blob) {
+    return DescriptorBuilder::FromBlob(blob.data(), blob.size());
+  };
+
+  // Counts far beyond what the blob can hold are rejected before allocating for them.
+  EXPECT_THROW(load(SealBlob(0xFFFFFFFF, {})), std::runtime_error);
+  EXPECT_THROW(load(SealBlob(1, {1, 0, 1, 'E', 0, 0, 0, 0, 0, 0, 0, 1, 0xFF, 0xFF, 0xFF, 0xFF})),
+               std::runtime_error);
+  EXPECT_THROW(load(SealBlob(1, {2, 0, 1, 'B', 0, 0, 0, 0, 0, 0, 0, 1, 0x7F, 0xFF, 0xFF, 0xFF})),
+               std::runtime_error);
+  EXPECT_THROW(load(SealBlob(1, {3, 0, 1, 'S', 0, 0, 0, 0, 0, 0, 0, 4, 0x10, 0x00, 0x00, 0x00})),
+               std::runtime_error);
+
+  // Arrays larger than their struct: a uint8 field of [0x7FFFFFFF] or [0xFFFFFFFF] elements, and
+  // one of [0x10000][0x10000] whose dimensions only overflow together.
+  for (const std::vector<uint8_t>& dims :
+       std::vector<std::vector<uint8_t>>{{1, 0x7F, 0xFF, 0xFF, 0xFF},
+                                         {1, 0xFF, 0xFF, 0xFF, 0xFF},
+                                         {2, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00}}) {
+    std::vector<uint8_t> record = {3, 0, 1, 'S', 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 1, 0, 1, 'f',
+                                   0, 0, 0, 0};
+    record.insert(record.end(), dims.begin(), dims.end());
+    EXPECT_THROW(load(SealBlob(1, record)), std::runtime_error);
+  }
+
+  // Random records.
+  std::mt19937 rng(1);
+  for (int i = 0; i < 2000; ++i) {
+    std::vector<uint8_t> records(rng() % 64);
+    for (uint8_t& byte : records) byte = rng() % 4 ? rng() % 8 : rng();
+    EXPECT_THROW(load(SealBlob(1 + rng() % 3, records)), std::runtime_error) << "iteration " << i;
+  }
+}
+
+// Type records with correct UIDs for a one bit bitfield B and a struct S holding B[n] (or uint8[n]
+// if bytes), claiming a packed size of n.  Type references 12 and up are the records (see
+// type_descriptors.cc).
+static std::vector<uint8_t> ArrayBlob(uint32_t n, bool bytes = false) {
+  std::vector<uint8_t> records;
+  auto write = [&records](uint32_t value, int size) {
+    for (int shift = 8 * (size - 1); shift >= 0; shift -= 8) records.push_back(value >> shift);
+  };
+
+  const uint32_t b_uid = ss::uid_hash::Bitfield("B", {ss::uid_hash::BitfieldField("a", 1)});
+  records.insert(records.end(), {2, 0, 1, 'B'});
+  write(b_uid, 4);
+  write(1, 4);
+  write(1, 4);
+  records.insert(records.end(), {0, 1, 'a', 1});
+
+  const uint32_t elem_uid = bytes ? ss::uid_hash::Primitive("uint8", 1) : b_uid;
+  const uint32_t f_uid = ss::uid_hash::StructField("f", ss::uid_hash::Array(elem_uid, n));
+  records.insert(records.end(), {3, 0, 1, 'S'});
+  write(ss::uid_hash::Struct("S", {f_uid}), 4);
+  write(n, 4);
+  write(1, 4);
+  records.insert(records.end(), {0, 1, 'f'});
+  write(bytes ? 0 : 12, 4);
+  write(1, 1);
+  write(n, 4);
+
+  return SealBlob(2, records);
+}
+
+TEST(DescriptorBlob, HugeTypes) {
+  auto load = [](const std::vector<uint8_t>& blob) {
+    return DescriptorBuilder::FromBlob(blob.data(), blob.size());
+  };
+
+  // Well formed, but describing far more than any real spec.  Both must fail fast without
+  // allocating for the sizes they claim: the first on its size alone, the second once its unpack
+  // plan (one op per bitfield element) outgrows the limit.
+  EXPECT_THROW(load(ArrayBlob(0x7FFFFFFF)), std::runtime_error);
+  EXPECT_THROW(load(ArrayBlob(20000000)), std::runtime_error);
+
+  // A long array of primitives is a single op, so it is fine.
+  const DescriptorBuilder types = load(ArrayBlob(20000000, true));
+  EXPECT_EQ(types["S"]->packed_size(), 20000000);
+  EXPECT_EQ(types["S"]->unpack_plan().size(), 1);
+}
+
+TEST(UnpackPlan, MergesPrimitiveRuns) {
+  DescriptorBuilder types = DescriptorBuilder::FromString(R"(
+Flags:
+  type: Bitfield
+  fields:
+    - a: 3
+    - b: 9
+Elem:
+  type: Struct
+  fields:
+    - x: float
+    - y: float
+    - flags: Flags
+Plan:
+  type: Message
+  fields:
+    - grid: [[uint32, 3], 8]
+    - elems: [Elem, 2]
+)");
+
+  const TypeDescriptor& plan_type = *types["Plan"];
+  std::vector<impl::UnpackOp> ops(plan_type.unpack_plan().begin(), plan_type.unpack_plan().end());
+
+  using Kind = impl::UnpackOp::Kind;
+
+  // ss_header (uid, len), grid as one run, then per elem: x/y as one run and two bitfield fields.
+  ASSERT_EQ(ops.size(), 9);
+  // Unpacked layout: ss_header (8 bytes), grid at 8, elems (12 bytes each) at 104.
+  EXPECT_EQ(plan_type.value_size(), 8 + 96 + 2 * 12);
+
+  EXPECT_EQ(ops[2].kind, Kind::kPrimitive);
+  EXPECT_EQ(ops[2].prim_type, PrimType::kUint32);
+  EXPECT_EQ(ops[2].src_offset, 6);
+  EXPECT_EQ(ops[2].dest_offset, 8);
+  EXPECT_EQ(ops[2].count, 24);
+
+  EXPECT_EQ(ops[6].kind, Kind::kPrimitive);
+  EXPECT_EQ(ops[6].prim_type, PrimType::kFloat);
+  EXPECT_EQ(ops[6].src_offset, 6 + 96 + 10);
+  EXPECT_EQ(ops[6].dest_offset, 8 + 96 + 12);
+  EXPECT_EQ(ops[6].count, 2);
+
+  EXPECT_EQ(ops[8].kind, Kind::kBitfield);
+  EXPECT_EQ(ops[8].container_type, PrimType::kUint16);
+  EXPECT_EQ(ops[8].prim_type, PrimType::kUint16);
+  EXPECT_EQ(ops[8].src_offset, 6 + 96 + 10 + 8);
+  EXPECT_EQ(ops[8].bit_offset, 3);
+  EXPECT_EQ(ops[8].bit_size, 9);
+  EXPECT_EQ(ops[8].mask, 0x1FF << 3);
+  EXPECT_EQ(ops[8].dest_offset, 8 + 96 + 12 + 8 + 2);
+
+  // Each bitfield's ops count down so its container is read once.
+  EXPECT_EQ(ops[7].count, 2);
+  EXPECT_EQ(ops[7].mask, 0x7);
+  EXPECT_EQ(ops[8].count, 1);
+}
@@ -0,0 +1,156 @@
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/dynamic/dynamic_types.h"
+#include "src/dynamic/type_descriptors.h"
+#include "src/dynamic/visitor.h"
+#include "test/dynamic/test_messages.h"
+
+using namespace ss::dynamic;
+using namespace ss::dynamic::test;
+using namespace testing;
+
+const std::string kYamlFile = "test/test_message_spec.yaml";
+
+// Records every event as text, with the C++ type each value arrived as.
+class TraceVisitor {
+ public:
+  void BeginStruct(const VisitNode& node) { Open(node, "{"); }
+  void EndStruct(const VisitNode&) { trace += "}"; }
+  void BeginArray(const VisitNode& node) { Open(node, "["); }
+  void EndArray(const VisitNode&) { trace += "]"; }
+
+  void Value(const VisitNode& node, uint8_t value) { Add(node, "u8", std::to_string(value)); }
+  void Value(const VisitNode& node, uint16_t value) { Add(node, "u16", std::to_string(value)); }
+  void Value(const VisitNode& node, uint32_t value) { Add(node, "u32", std::to_string(value)); }
+  void Value(const VisitNode& node, uint64_t value) { Add(node, "u64", std::to_string(value)); }
+  void Value(const VisitNode& node, int8_t value) { Add(node, "i8", std::to_string(value)); }
+  void Value(const VisitNode& node, int16_t value) { Add(node, "i16", std::to_string(value)); }
+  void Value(const VisitNode& node, int32_t value) { Add(node, "i32", std::to_string(value)); }
+  void Value(const VisitNode& node, int64_t value) { Add(node, "i64", std::to_string(value)); }
+  void Value(const VisitNode& node, bool value) { Add(node, "b", value ? "1" : "0"); }
+  void Value(const VisitNode& node, float value) { Add(node, "f", std::to_string(value)); }
+  void Value(const VisitNode& node, double value) { Add(node, "d", std::to_string(value)); }
+
+  std::string trace;
+
+ private:
+  void Open(const VisitNode& node, const char *bracket) {
+    Separate();
+    trace += std::string(node.name()) + bracket;
+  }
+
+  void Add(const VisitNode& node, const char *type, const std::string& value) {
+    Separate();
+    trace += node.field ? std::string(node.name()) : "[" + std::to_string(node.index) + "]";
+    trace += std::string(":") + type + "=" + value;
+  }
+
+  void Separate() {
+    if (!trace.empty() && trace.back() != '{' && trace.back() != '[') trace += ' ';
+  }
+};
+
+TEST(Visit, Events) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["Bitfield4BytesTest"];
+
+  DynamicStruct msg(type);
+  msg.Get<DynamicStruct>("bitfield").Get<uint8_t>("field0") = 5;
+  msg.Get<DynamicStruct>("bitfield").Get<uint8_t>("field1") = 31;
+  msg.Get<DynamicStruct>("bitfield").Get<uint16_t>("field2") = 300;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  TraceVisitor visitor;
+  Visit(data.data(), VisitPlan::Compile(type), visitor);
+  EXPECT_EQ(visitor.trace, "{ss_header{uid:u32=" + std::to_string(type.uid()) +
+                               " len:u16=10} bitfield{field0:u8=5 field1:u8=31 field2:u16=300}}");
+}
+
+TEST(Visit, Types) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["PrimitiveTest"];
+
+  DynamicStruct msg(type);
+  msg.Get<uint64_t>("uint64") = 1ull << 40;
+  msg.Get<int8_t>("int8") = -3;
+  msg.Get<bool>("boolean") = true;
+  msg.Get<double>("double_type") = 0.5;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  TraceVisitor visitor;
+  Visit(data.data(), VisitPlan::Compile(type), visitor);
+  EXPECT_THAT(visitor.trace,
+              HasSubstr("uint8:u8=0 uint16:u16=0 uint32:u32=0 uint64:u64=1099511627776 "
+                        "int8:i8=-3 int16:i16=0 int32:i32=0 int64:i64=0 boolean:b=1 "
+                        "float_type:f=0.000000 double_type:d=0.500000}"));
+
+  DynamicStruct enumeration(*types["Enum2BytesTest"]);
+  enumeration.Get<int16_t>("enumeration") = 100;
+  TraceVisitor enum_visitor;
+  Visit(Pack(enumeration).data(), VisitPlan::Compile(*types["Enum2BytesTest"]), enum_visitor);
+  EXPECT_THAT(enum_visitor.trace, EndsWith(" enumeration:i16=100}"));
+}
+
+TEST(Visit, Arrays) {
+  DescriptorBuilder types = DescriptorBuilder::FromFile(kYamlFile);
+  const TypeDescriptor& type = *types["ArrayTest"];
+
+  DynamicStruct msg(type);
+  msg.Get<DynamicArray>("array_2d").Get<DynamicArray>(1).Get<DynamicStruct>(2).Get<uint16_t>(
+      "field1") = 77;
+  const std::vector<uint8_t> data = Pack(msg);
+
+  // A visitor only interested in some events.
+  struct PathVisitor : NullVisitor {
+    using NullVisitor::Value;
+
+    void BeginArray(const VisitNode& node) {
+      BeginStruct(node);
+      if (node.field) path.push_back(std::string(node.name()));
+      path.push_back("");
+    }
+    void EndArray(const VisitNode& node) { path.resize(path.size() - (node.field ? 2 : 1)); }
+    void BeginStruct(const VisitNode& node) {
+      if (node.index >= 0) path.back() = "[" + std::to_string(node.index) + "]";
+    }
+
+    void Value(const VisitNode& node, uint16_t value) {
+      if (value == 0 || node.name() != "field1") return;
+      std::string name;
+      for (const std::string& part : path) name += part;
+      found.push_back(name + "." + std::string(node.name()) + " depth " +
+                      std::to_string(node.depth));
+    }
+
+    std::vector<std::string> path;
+    std::vector<std::string> found;
+  };
+
+  PathVisitor visitor;
+  const VisitPlan plan = VisitPlan::Compile(type);
+  Visit(data.data(), plan, visitor);
+  EXPECT_THAT(visitor.path, IsEmpty());
+  EXPECT_THAT(visitor.found, ElementsAre("array_2d[1][2].field1 depth 4"));
+
+  // One event per value plus begin and end of each struct and array: the message, ss_header,
+  // 15 ArrayElems and 8 arrays.
+  EXPECT_EQ(plan.size(), 2 * (1 + 1 + 15 + 8) + 2 + 15 * 2);
+
+  TraceVisitor array_visitor;
+  const TypeDescriptor& position = types["AliasTest"]->struct_fields()[1]->type();
+  ASSERT_TRUE(position.IsArray());
+  std::vector<uint8_t> floats(position.packed_size());
+  floats[4] = 0x3F;
+  floats[5] = 0x80;
+  Visit(floats.data(), VisitPlan::Compile(position), array_visitor);
+  EXPECT_EQ(array_visitor.trace, "[[0]:f=0.000000 [1]:f=1.000000 [2]:f=0.000000]");
+
+  EXPECT_THROW(VisitPlan::Compile(*types["uint8"]), std::runtime_error);
+}
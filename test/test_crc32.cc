@@ -1,5 +1,6 @@
 #include "src/crc32.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <string>
@@ -42,3 +43,108 @@ TEST(Crc32, String) {
   std::string input = "Hello World!";
   EXPECT_EQ(GetCrc32(input), 0x1C291CA3);
 }
+
+TEST(Crc32, SliceTables) {
+  constexpr auto kTables = GenerateCrc32SliceTables<16>();
+  constexpr auto kTable = GenerateCrc32Table();
+  EXPECT_EQ(kTables[0], kTable);
+
+  // Table k is the CRC register after a byte and k zero bytes.
+  for (size_t k = 1; k < kTables.size(); ++k) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      std::vector<uint8_t> input(k);
+      EXPECT_EQ(kTables[k][i], impl::Crc32UpdateBytewise(kTable[i], input.data(), input.size()));
+    }
+  }
+}
+
+TEST(Crc32, KernelsMatchBytewise) {
+  std::vector<uint8_t> input(4096 + 64);
+  uint32_t state = 0x12345678;
+  for (uint8_t& byte : input) {
+    state = state * 1664525 + 1013904223;
+    byte = state >> 24;
+  }
+
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t len : {0, 1, 7, 8, 9, 15, 16, 17, 31, 255, 256, 257, 1000, 4096}) {
+      const uint8_t *buf = input.data() + offset;
+      const uint32_t expected = impl::Crc32UpdateBytewise(0xFFFFFFFF, buf, len) ^ 0xFFFFFFFF;
+
+      EXPECT_EQ(impl::Crc32UpdateSlice8(0xFFFFFFFF, buf, len) ^ 0xFFFFFFFF, expected);
+      EXPECT_EQ(impl::Crc32UpdateSlice16(0xFFFFFFFF, buf, len) ^ 0xFFFFFFFF, expected);
+      EXPECT_EQ(GetCrc32(buf, len), expected);
+    }
+  }
+}
+
+#ifdef SS_X86
+TEST(Crc32, ClmulMatchesTable) {
+  if (!impl::Crc32ClmulSupported()) GTEST_SKIP() << "CPU lacks PCLMULQDQ / SSE4.1.";
+
+  std::vector<uint8_t> input(1 << 16);
+  uint32_t state = 0xDEADBEEF;
+  for (uint8_t& byte : input) {
+    state = state * 1664525 + 1013904223;
+    byte = state >> 24;
+  }
+
+  for (int i = 0; i < 2000; ++i) {
+    state = state * 1664525 + 1013904223;
+    const size_t offset = (state >> 8) % 64;
+    state = state * 1664525 + 1013904223;
+    const size_t len =
+        impl::kCrc32ClmulMinLen + (state >> 8) % (input.size() - offset - impl::kCrc32ClmulMinLen);
+
+    const uint8_t *buf = input.data() + offset;
+    const uint32_t init = state;
+    EXPECT_EQ(impl::Crc32UpdateClmul(init, buf, len), impl::Crc32UpdateSlice16(init, buf, len))
+        << "offset: " << offset << " len: " << len;
+  }
+}
+#endif
+
+TEST(Crc32State, MatchesOneShot) {
+  std::vector<uint8_t> input(5000);
+  for (size_t i = 0; i < input.size(); ++i) input[i] = i * 7 + 3;
+
+  const uint32_t expected = GetCrc32(input);
+
+  for (size_t chunk : {1, 3, 16, 63, 64, 1000, 5000}) {
+    Crc32State state;
+    for (size_t i = 0; i < input.size(); i += chunk) {
+      state.Update(input.data() + i, std::min(chunk, input.size() - i));
+    }
+    EXPECT_EQ(state.Finalize(), expected) << "chunk: " << chunk;
+    EXPECT_EQ(state.len(), input.size());
+  }
+
+  Crc32State state;
+  state.Update(std::string("Hello "));
+  state.Update(std::string("World!"));
+  EXPECT_EQ(state.Finalize(), 0x1C291CA3);
+
+  state.Reset();
+  EXPECT_EQ(state.Finalize(), GetCrc32(nullptr, 0));
+}
+
+TEST(Crc32Combine, MatchesWhole) {
+  std::vector<uint8_t> input(10000);
+  for (size_t i = 0; i < input.size(); ++i) input[i] = i * 13 + 5;
+
+  const uint32_t expected = GetCrc32(input);
+
+  for (size_t split : {0, 1, 15, 64, 4097, 9999, 10000}) {
+    const uint32_t crc_a = GetCrc32(input.data(), split);
+    const uint32_t crc_b = GetCrc32(input.data() + split, input.size() - split);
+    EXPECT_EQ(Crc32Combine(crc_a, crc_b, input.size() - split), expected) << "split: " << split;
+  }
+
+  // Combine several chunks in order, as when checksumming a file in parallel.
+  uint32_t crc = GetCrc32(nullptr, 0);
+  for (size_t i = 0; i < input.size(); i += 1234) {
+    const size_t len = std::min<size_t>(1234, input.size() - i);
+    crc = Crc32Combine(crc, GetCrc32(input.data() + i, len), len);
+  }
+  EXPECT_EQ(crc, expected);
+}
@@ -0,0 +1,95 @@
+#include "src/perfect_hash.h"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace ss;
+
+namespace {
+
+std::vector<uint32_t> RandomUids(size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::unordered_set<uint32_t> seen;
+  std::vector<uint32_t> uids;
+  while (uids.size() < count) {
+    const uint32_t uid = rng();
+    if (seen.insert(uid).second) uids.push_back(uid);
+  }
+  return uids;
+}
+
+void ExpectPerfect(const std::vector<uint32_t>& uids, const perfect_hash::Table& table) {
+  ASSERT_EQ(table.slots.size(), size_t{1} << table.bits);
+  ASSERT_EQ(table.displacements.size(), size_t{1} << table.bucket_bits);
+  EXPECT_GE(table.slots.size(), uids.size());
+
+  size_t num_empty = 0;
+  for (uint32_t slot : table.slots) {
+    if (slot == uids.size()) ++num_empty;
+  }
+  EXPECT_EQ(num_empty, table.slots.size() - uids.size());
+
+  for (size_t i = 0; i < uids.size(); ++i) {
+    EXPECT_EQ(table.Lookup(uids[i]), i);
+  }
+}
+
+}  // namespace
+
+TEST(PerfectHash, Empty) {
+  const perfect_hash::Table table = perfect_hash::Find({});
+  EXPECT_EQ(table.bits, 1);
+  EXPECT_EQ(table.slots, std::vector<uint32_t>({0, 0}));
+  EXPECT_EQ(table.Lookup(0x12345678), 0u);
+}
+
+TEST(PerfectHash, RandomUids) {
+  for (size_t count : {1, 2, 3, 10, 100, 1000, 5000}) {
+    const std::vector<uint32_t> uids = RandomUids(count, count);
+    ExpectPerfect(uids, perfect_hash::Find(uids));
+  }
+}
+
+TEST(PerfectHash, LinearSize) {
+  for (size_t count : {100, 200, 500, 1000, 5000}) {
+    const perfect_hash::Table table = perfect_hash::Find(RandomUids(count, count + 1));
+    EXPECT_LE(table.slots.size(), 2 * count);
+    EXPECT_LE(table.displacements.size(), count);
+  }
+
+  const perfect_hash::Table table = perfect_hash::Find(RandomUids(1000, 7));
+  EXPECT_LE(table.slots.size() + table.displacements.size(), 4096u);
+}
+
+TEST(PerfectHash, NonUids) {
+  const std::vector<uint32_t> uids = RandomUids(300, 3);
+  const perfect_hash::Table table = perfect_hash::Find(uids);
+  const std::unordered_set<uint32_t> known(uids.begin(), uids.end());
+
+  // Any input lands on some entry, which the caller's UID compare rejects.
+  for (const uint32_t uid : RandomUids(1000, 4)) {
+    if (known.count(uid)) continue;
+    const uint32_t i = table.Lookup(uid);
+    EXPECT_LE(i, uids.size());
+    if (i < uids.size()) {
+      EXPECT_NE(uids[i], uid);
+    }
+  }
+}
+
+TEST(PerfectHash, Duplicates) {
+  EXPECT_THROW(perfect_hash::Find({1, 2, 1}), std::runtime_error);
+}
+
+TEST(PerfectHash, Multiplier) {
+  // Must match src/perfect_hash.py.
+  static_assert(perfect_hash::Multiplier(0) == 0x0DCD30DFu);
+  for (uint32_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(perfect_hash::Multiplier(i) & 1, 1u);
+  }
+}
@@ -0,0 +1,88 @@
+#include "src/uid_hash.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/crc32.h"
+
+using namespace ss;
+
+// UIDs can be computed and checked at compile time.
+constexpr uint32_t kUint8Uid = uid_hash::Primitive("uint8", 1);
+constexpr uint32_t kUint16Uid = uid_hash::Primitive("uint16", 2);
+constexpr uint32_t kUint32Uid = uid_hash::Primitive("uint32", 4);
+constexpr uint32_t kUint64Uid = uid_hash::Primitive("uint64", 8);
+constexpr uint32_t kInt8Uid = uid_hash::Primitive("int8", 1);
+constexpr uint32_t kInt16Uid = uid_hash::Primitive("int16", 2);
+constexpr uint32_t kInt32Uid = uid_hash::Primitive("int32", 4);
+constexpr uint32_t kInt64Uid = uid_hash::Primitive("int64", 8);
+constexpr uint32_t kBoolUid = uid_hash::Primitive("bool", 1);
+constexpr uint32_t kFloatUid = uid_hash::Primitive("float", 4);
+constexpr uint32_t kDoubleUid = uid_hash::Primitive("double", 8);
+
+constexpr uint32_t kSsHeaderUid =
+    uid_hash::Struct("SsHeader", {uid_hash::StructField("uid", kUint32Uid),
+                                  uid_hash::StructField("len", kUint16Uid)});
+
+static_assert(kUint8Uid == 1635920604);
+static_assert(kSsHeaderUid == 1168420962);
+
+static_assert(uid_hash::Struct("PrimitiveTest",
+                               {
+                                   uid_hash::StructField("ss_header", kSsHeaderUid),
+                                   uid_hash::StructField("uint8", kUint8Uid),
+                                   uid_hash::StructField("uint16", kUint16Uid),
+                                   uid_hash::StructField("uint32", kUint32Uid),
+                                   uid_hash::StructField("uint64", kUint64Uid),
+                                   uid_hash::StructField("int8", kInt8Uid),
+                                   uid_hash::StructField("int16", kInt16Uid),
+                                   uid_hash::StructField("int32", kInt32Uid),
+                                   uid_hash::StructField("int64", kInt64Uid),
+                                   uid_hash::StructField("boolean", kBoolUid),
+                                   uid_hash::StructField("float_type", kFloatUid),
+                                   uid_hash::StructField("double_type", kDoubleUid),
+                               }) == 710579723);
+
+// Reference implementation: build the canonical string and CRC it.
+static uint32_t ReferenceHash(const std::string& first, const std::vector<int64_t>& items) {
+  std::string s = first;
+  for (int64_t item : items) {
+    s += ", " + std::to_string(item);
+  }
+  return GetCrc32(s);
+}
+
+TEST(UidHash, MatchesCanonicalString) {
+  EXPECT_EQ(PrimitiveHash("float", 4), ReferenceHash("float", {4}));
+  EXPECT_EQ(ArrayHash(4294967295u, 12), ReferenceHash("4294967295", {12}));
+  EXPECT_EQ(ArrayHash(0, 3), ReferenceHash("0", {3}));
+  EXPECT_EQ(BitfieldFieldHash("field0", 3), ReferenceHash("field0", {3}));
+  EXPECT_EQ(EnumValueHash("Value1", 1), ReferenceHash("Value1", {1}));
+  EXPECT_EQ(EnumValueHash("Negative", -128), ReferenceHash("Negative", {-128}));
+  EXPECT_EQ(StructFieldHash("field", 3000000000u), ReferenceHash("field", {3000000000}));
+
+  std::vector<uint32_t> uids = {0, 1, 10, 99, 100, 4294967295u, 123456789};
+  const std::vector<int64_t> items(uids.begin(), uids.end());
+  EXPECT_EQ(StructHash("Struct", uids.data(), uids.size()), ReferenceHash("Struct", items));
+  EXPECT_EQ(EnumHash("Enum", uids.data(), uids.size()), ReferenceHash("Enum", items));
+  EXPECT_EQ(BitfieldHash("Bitfield", uids.data(), uids.size()), ReferenceHash("Bitfield", items));
+  EXPECT_EQ(StructHash("Empty", nullptr, 0), ReferenceHash("Empty", {}));
+}
+
+TEST(UidHash, ConstexprMatchesRuntime) {
+  EXPECT_EQ(uid_hash::Primitive("double", 8), PrimitiveHash("double", 8));
+  EXPECT_EQ(uid_hash::Array(kUint8Uid, 3), ArrayHash(kUint8Uid, 3));
+
+  constexpr std::array<uint32_t, 3> kValues = {
+      uid_hash::EnumValue("A", 0),
+      uid_hash::EnumValue("B", 1),
+      uid_hash::EnumValue("C", 2),
+  };
+  std::array<uint32_t, 3> values = kValues;
+  constexpr uint32_t kEnumUid = uid_hash::Enum("Abc", kValues);
+  EXPECT_EQ(kEnumUid, EnumHash("Abc", values.data(), values.size()));
+}
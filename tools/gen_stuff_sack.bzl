@@ -3,7 +3,14 @@ load("@rules_sphinx//sphinx:defs.bzl", "sphinx_html")
 COPTS = ["-std=c17", "-Wall", "-Werror"]
 CXXOPTS = ["-std=c++17", "-Wall", "-Werror"]
 
-def c_stuff_sack(name, message_spec, deps = None, includes = None, alias_tag = None, **kwargs):
+def c_stuff_sack(
+        name,
+        message_spec,
+        deps = None,
+        includes = None,
+        alias_tag = None,
+        log_header = None,
+        **kwargs):
     if deps == None:
         deps = []
 
@@ -18,12 +25,13 @@ def c_stuff_sack(name, message_spec, deps = None, includes = None, alias_tag = N
             name + ".h",
         ],
         cmd = ("$(execpath @stuff_sack//src:c_stuff_sack) --spec $(execpath {}) " +
-               "--source $(execpath {}) --header $(execpath {}) --includes {}{}").format(
+               "--source $(execpath {}) --header $(execpath {}) --includes {}{}{}").format(
             message_spec,
             name + ".c",
             name + ".h",
             " ".join(["src/logging.h"] + includes),
             " --alias_tag {}".format(alias_tag) if alias_tag else "",
+            " --log_header {}".format(log_header) if log_header else "",
         ),
         tools = ["@stuff_sack//src:c_stuff_sack"],
         visibility = ["//visibility:private"],
@@ -136,6 +144,18 @@ def py_stuff_sack(name, message_spec, **kwargs):
         **kwargs
     )
 
+def descriptor_blob(name, message_spec, **kwargs):
+    native.genrule(
+        name = name,
+        srcs = [message_spec],
+        outs = [name + ".ssdb"],
+        cmd = "$(execpath @stuff_sack//src:descriptor_blob) --spec $(execpath {}) --output $@".format(
+            message_spec,
+        ),
+        tools = ["@stuff_sack//src:descriptor_blob"],
+        **kwargs
+    )
+
 def doc_stuff_sack(name, message_spec, c_alias_tag = None, cc_alias_tag = None, **kwargs):
     native.genrule(
         name = name + "-doc-gen",
@@ -184,11 +204,12 @@ def all_stuff_sack(
         c_deps = None,
         c_includes = None,
         c_alias_tag = None,
+        c_log_header = None,
         cc_deps = None,
         cc_includes = None,
         cc_alias_tag = None,
         **kwargs):
-    c_stuff_sack(name, message_spec, c_deps, c_includes, c_alias_tag, **kwargs)
+    c_stuff_sack(name, message_spec, c_deps, c_includes, c_alias_tag, c_log_header, **kwargs)
     cc_stuff_sack(name, message_spec, cc_deps, cc_includes, cc_alias_tag, **kwargs)
     py_stuff_sack(name, message_spec, **kwargs)
     doc_stuff_sack(name, message_spec, c_alias_tag, cc_alias_tag, **kwargs)